@@ -3,6 +3,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
+#include <utility>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
@@ -81,34 +82,36 @@ double distributedClient(const char* serverIP, int numThreads, int clientSocketF
     //std::cout << "Received u array (" << totalBytes << " bytes)" << std::endl;
 
     double maxDiff = 0.0;
-    for (int iter = 0; iter < ITER; iter++) {
-        // Copy u to uu
-        #pragma omp parallel for collapse(2)
-        for (int x = 0; x < XSIZE; x++) {
-            for (int y = 0; y < YSIZE; y++) {
-                uu[x][y] = u[x][y];
-            }
+    // u and uu are swapped between sweeps instead of copied, so both need the boundary values
+    #pragma omp parallel for collapse(2)
+    for (int x = 0; x < XSIZE; x++) {
+        for (int y = 0; y < YSIZE; y++) {
+            uu[x][y] = u[x][y];
         }
-
+    }
+    double (*cur)[YSIZE] = u;
+    double (*next)[YSIZE] = uu;
+    for (int iter = 0; iter < ITER; iter++) {
         // Client computes rows 1 to halfRows-1
         double localMaxDiff = 0.0;
         #pragma omp parallel for collapse(2) reduction(max:localMaxDiff)
         for (int x = 1; x < halfRows; x++) {
             for (int y = 1; y < YSIZE - 1; y++) {
-                double newVal = 0.25 * (uu[x-1][y] + uu[x+1][y] + uu[x][y-1] + uu[x][y+1]);
-                double diff = std::abs(newVal - u[x][y]);
+                double newVal = 0.25 * (cur[x-1][y] + cur[x+1][y] + cur[x][y-1] + cur[x][y+1]);
+                double diff = std::abs(newVal - cur[x][y]);
                 if (diff > localMaxDiff) localMaxDiff = diff;
-                u[x][y] = newVal;
+                next[x][y] = newVal;
             }
         }
         maxDiff = localMaxDiff;
+        std::swap(cur, next);
 
         // Exchange rows 1 to halfRows-1 with server
         size_t exchangeBytes = (halfRows - 1) * YSIZE * sizeof(double);
         size_t totalSent = 0;
         while (totalSent < exchangeBytes) {
             size_t chunkSize = std::min(static_cast<size_t>(MAXBUFFERSIZE), exchangeBytes - totalSent);
-            ssize_t bytesSent = send(clientSocketFD, (char*)&u[1][0] + totalSent, chunkSize, 0);
+            ssize_t bytesSent = send(clientSocketFD, (char*)&cur[1][0] + totalSent, chunkSize, 0);
             if (bytesSent <= 0) {
                 std::cerr << "Error sending u update at iter " << iter << ", offset " << totalSent << std::endl;
                 return -1.0;
@@ -119,7 +122,7 @@ double distributedClient(const char* serverIP, int numThreads, int clientSocketF
         totalRecv = 0;
         while (totalRecv < exchangeBytes) {
             size_t chunkSize = std::min(static_cast<size_t>(MAXBUFFERSIZE), exchangeBytes - totalRecv);
-            bytesRecv = recv(clientSocketFD, (char*)&u[1][0] + totalRecv, chunkSize, 0);
+            bytesRecv = recv(clientSocketFD, (char*)&cur[1][0] + totalRecv, chunkSize, 0);
             if (bytesRecv <= 0) {
                 std::cerr << "Error receiving u update at iter " << iter << ", offset " << totalRecv << std::endl;
                 return -1.0;
@@ -128,6 +131,15 @@ double distributedClient(const char* serverIP, int numThreads, int clientSocketF
         }
     }
 
+    // Copy the final sweep back into u when it ended up in uu
+    if (cur != u) {
+        for (int x = 0; x < XSIZE; x++) {
+            for (int y = 0; y < YSIZE; y++) {
+                u[x][y] = cur[x][y];
+            }
+        }
+    }
+
     // Send maxDiff to server
     size_t totalSent = 0;
     while (totalSent < sizeof(double)) {
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
+#include <utility>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <omp.h>
@@ -86,33 +87,37 @@ double distributedServer(int numThreads, int clientSocketFD) {
     //std::cout << "Sent u array (" << totalBytes << " bytes) to client" << std::endl;
 
     double maxDiff = 0.0;
-    for (int iter = 0; iter < ITER; iter++) {
-        #pragma omp parallel for collapse(2)
-        for (int x = 0; x < XSIZE; x++) {
-            for (int y = 0; y < YSIZE; y++) {
-                uu[x][y] = u[x][y];
-            }
+    // u and uu are swapped between sweeps instead of copied, so both need the boundary values
+    #pragma omp parallel for collapse(2)
+    for (int x = 0; x < XSIZE; x++) {
+        for (int y = 0; y < YSIZE; y++) {
+            uu[x][y] = u[x][y];
         }
-
+    }
+    double (*cur)[YSIZE] = u;
+    double (*next)[YSIZE] = uu;
+    for (int iter = 0; iter < ITER; iter++) {
         // Server computes rows halfRows to XSIZE-2 (excluding boundary)
         double localMaxDiff = 0.0;
         #pragma omp parallel for collapse(2) reduction(max:localMaxDiff)
         for (int x = halfRows; x < XSIZE - 1; x++) {
             for (int y = 1; y < YSIZE - 1; y++) {
-                double newVal = 0.25 * (uu[x-1][y] + uu[x+1][y] + uu[x][y-1] + uu[x][y+1]);
-                double diff = std::abs(newVal - u[x][y]);
+                double newVal = 0.25 * (cur[x-1][y] + cur[x+1][y] + cur[x][y-1] + cur[x][y+1]);
+                double diff = std::abs(newVal - cur[x][y]);
                 if (diff > localMaxDiff) localMaxDiff = diff;
-                u[x][y] = newVal;
+                next[x][y] = newVal;
             }
         }
         maxDiff = localMaxDiff;
+        std::swap(cur, next);
 
-        // Exchange rows 1 to halfRows-1 with client
+        // Exchange rows 1 to halfRows-1 with client. The server never writes them, so the rows received
+        // in the last exchange are in next (the buffer swept from); cur holds the ones from the exchange before
         size_t exchangeBytes = (halfRows - 1) * YSIZE * sizeof(double);
         totalSent = 0;
         while (totalSent < exchangeBytes) {
             size_t chunkSize = std::min(static_cast<size_t>(MAXBUFFERSIZE), exchangeBytes - totalSent);
-            bytesSent = send(clientSocketFD, (char*)&u[1][0] + totalSent, chunkSize, 0);
+            bytesSent = send(clientSocketFD, (char*)&next[1][0] + totalSent, chunkSize, 0);
             if (bytesSent <= 0) {
                 std::cerr << "Error sending u update at iter " << iter << ", offset " << totalSent << std::endl;
                 return -1.0;
@@ -123,7 +128,7 @@ double distributedServer(int numThreads, int clientSocketFD) {
         size_t totalRecv = 0;
         while (totalRecv < exchangeBytes) {
             size_t chunkSize = std::min(static_cast<size_t>(MAXBUFFERSIZE), exchangeBytes - totalRecv);
-            ssize_t bytesRecv = recv(clientSocketFD, (char*)&u[1][0] + totalRecv, chunkSize, 0);
+            ssize_t bytesRecv = recv(clientSocketFD, (char*)&cur[1][0] + totalRecv, chunkSize, 0);
             if (bytesRecv <= 0) {
                 std::cerr << "Error receiving u update at iter " << iter << ", offset " << totalRecv << std::endl;
                 return -1.0;
@@ -132,6 +137,15 @@ double distributedServer(int numThreads, int clientSocketFD) {
         }
     }
 
+    // Copy the final sweep back into u when it ended up in uu
+    if (cur != u) {
+        for (int x = 0; x < XSIZE; x++) {
+            for (int y = 0; y < YSIZE; y++) {
+                u[x][y] = cur[x][y];
+            }
+        }
+    }
+
     // Receive client's maxDiff
     double clientMaxDiff = 0.0;
     size_t totalRecv = 0;
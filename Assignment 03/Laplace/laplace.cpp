@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <unistd.h>
 #include <cmath>
+#include <utility>
 #include <Python.h>
 #include "matplotlibcpp.h"
 
@@ -64,27 +65,41 @@ void plotHeatmap() {
     Py_Finalize();
 }
 
-// Serial Laplace solver
+// Copy the final sweep back into u when it ended up in uu
+void keepResultInU(double (*cur)[YSIZE]) {
+    if (cur == u) return;
+    for (int x = 0; x < XSIZE; x++) {
+        for (int y = 0; y < YSIZE; y++) {
+            u[x][y] = cur[x][y];
+        }
+    }
+}
+
+// Serial Laplace solver, swapping u and uu between sweeps instead of copying
 double serialLaplace() {
     double maxDiff = 0.0;
-    for (int iter = 0; iter < ITER; iter++) {
-        // Copy u to uu
-        for (int x = 0; x < XSIZE; x++) {
-            for (int y = 0; y < YSIZE; y++) {
-                uu[x][y] = u[x][y];
-            }
+    // Both buffers need the boundary values, only interior points are written afterwards
+    for (int x = 0; x < XSIZE; x++) {
+        for (int y = 0; y < YSIZE; y++) {
+            uu[x][y] = u[x][y];
         }
-        // Update u
+    }
+    double (*cur)[YSIZE] = u;
+    double (*next)[YSIZE] = uu;
+    for (int iter = 0; iter < ITER; iter++) {
+        // Update next from cur
         maxDiff = 0.0;
         for (int x = 1; x < XSIZE - 1; x++) {
             for (int y = 1; y < YSIZE - 1; y++) {
-                double newVal = 0.25 * (uu[x-1][y] + uu[x+1][y] + uu[x][y-1] + uu[x][y+1]);
-                double diff = std::abs(newVal - u[x][y]);
+                double newVal = 0.25 * (cur[x-1][y] + cur[x+1][y] + cur[x][y-1] + cur[x][y+1]);
+                double diff = std::abs(newVal - cur[x][y]);
                 if (diff > maxDiff) maxDiff = diff;
-                u[x][y] = newVal;
+                next[x][y] = newVal;
             }
         }
+        std::swap(cur, next);
     }
+    keepResultInU(cur);
     return maxDiff;
 }
 
@@ -92,27 +107,30 @@ double serialLaplace() {
 double openMPLaplace(int numThreads) {
     omp_set_num_threads(numThreads);
     double maxDiff = 0.0;
-    for (int iter = 0; iter < ITER; iter++) {
-        // Copy u to uu
-        #pragma omp parallel for collapse(2)
-        for (int x = 0; x < XSIZE; x++) {
-            for (int y = 0; y < YSIZE; y++) {
-                uu[x][y] = u[x][y];
-            }
+    #pragma omp parallel for collapse(2)
+    for (int x = 0; x < XSIZE; x++) {
+        for (int y = 0; y < YSIZE; y++) {
+            uu[x][y] = u[x][y];
         }
-        // Update u
+    }
+    double (*cur)[YSIZE] = u;
+    double (*next)[YSIZE] = uu;
+    for (int iter = 0; iter < ITER; iter++) {
+        // Update next from cur
         double localMaxDiff = 0.0;
         #pragma omp parallel for collapse(2) reduction(max:localMaxDiff)
         for (int x = 1; x < XSIZE - 1; x++) {
             for (int y = 1; y < YSIZE - 1; y++) {
-                double newVal = 0.25 * (uu[x-1][y] + uu[x+1][y] + uu[x][y-1] + uu[x][y+1]);
-                double diff = std::abs(newVal - u[x][y]);
+                double newVal = 0.25 * (cur[x-1][y] + cur[x+1][y] + cur[x][y-1] + cur[x][y+1]);
+                double diff = std::abs(newVal - cur[x][y]);
                 if (diff > localMaxDiff) localMaxDiff = diff;
-                u[x][y] = newVal;
+                next[x][y] = newVal;
             }
         }
         maxDiff = localMaxDiff;
+        std::swap(cur, next);
     }
+    keepResultInU(cur);
     return maxDiff;
 }
 
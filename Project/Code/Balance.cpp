@@ -0,0 +1,125 @@
+// Including Packages
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <mpi.h>
+#include "Balance.h"
+#include "Laplace.h"
+#include "Simd.h"
+
+std::vector<double> readBalanceWeights(const std::string& path, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Rank 0 reads the file and every rank picks its own line
+    std::string text;
+    int length = -1;
+    if (rank == 0) {
+        std::ifstream file(path.c_str());
+        if (file) {
+            std::stringstream ss;
+            ss << file.rdbuf();
+            text = ss.str();
+            length = (int)text.size();
+        }
+    }
+    MPI_Bcast(&length, 1, MPI_INT, 0, comm);
+    if (length < 0) return std::vector<double>();
+    text.resize(length);
+    if (length > 0) MPI_Bcast(&text[0], length, MPI_CHAR, 0, comm);
+
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int host_len;
+    MPI_Get_processor_name(host, &host_len);
+    host[host_len] = '\0';
+    std::stringstream rank_name;
+    rank_name << rank;
+
+    double weight = 1.0;
+    bool by_rank = false;
+    std::stringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::stringstream fields(line);
+        std::string name;
+        double value;
+        if (!(fields >> name >> value) || name[0] == '#' || value <= 0.0) continue;
+        if (name == rank_name.str()) {
+            weight = value;
+            by_rank = true;
+        } else if (name == host && !by_rank) {
+            weight = value;
+        }
+    }
+    std::vector<double> weights(size);
+    MPI_Allgather(&weight, 1, MPI_DOUBLE, &weights[0], 1, MPI_DOUBLE, comm);
+    return weights;
+}
+
+std::vector<int> partitionRows(int total, const std::vector<double>& weights, int min_rows) {
+    int parts = (int)weights.size();
+    double sum = 0.0;
+    for (int i = 0; i < parts; i++) sum += weights[i];
+
+    // Largest remainder rounding of the proportional shares
+    std::vector<int> rows(parts);
+    std::vector<std::pair<double, int> > remainders(parts);
+    int assigned = 0;
+    for (int i = 0; i < parts; i++) {
+        double share = (sum > 0.0) ? total * weights[i] / sum : (double)total / parts;
+        rows[i] = (int)share;
+        remainders[i] = std::make_pair(share - rows[i], i);
+        assigned += rows[i];
+    }
+    std::sort(remainders.begin(), remainders.end(), std::greater<std::pair<double, int> >());
+    for (int k = 0; assigned < total; k = (k + 1) % parts, assigned++) rows[remainders[k].second]++;
+
+    // Top up thin strips from the largest ones
+    for (int i = 0; i < parts; i++) {
+        while (rows[i] < min_rows) {
+            int largest = (int)(std::max_element(rows.begin(), rows.end()) - rows.begin());
+            if (rows[largest] <= min_rows) break;
+            rows[largest]--;
+            rows[i]++;
+        }
+    }
+    return rows;
+}
+
+void migrateRows(double*& strip, int& local_rows, const std::vector<int>& old_rows,
+                 const std::vector<int>& new_rows, int ysize, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    std::vector<int> old_start(size + 1, 0), new_start(size + 1, 0);
+    for (int r = 0; r < size; r++) {
+        old_start[r + 1] = old_start[r] + old_rows[r];
+        new_start[r + 1] = new_start[r] + new_rows[r];
+    }
+
+    // Rows go to every rank whose new range overlaps our old one, and come from every rank
+    // whose old range overlaps our new one; counts and displacements are in rows
+    std::vector<int> send_counts(size), send_displs(size), recv_counts(size), recv_displs(size);
+    for (int r = 0; r < size; r++) {
+        int a = std::max(old_start[rank], new_start[r]);
+        int b = std::min(old_start[rank + 1], new_start[r + 1]);
+        send_counts[r] = std::max(0, b - a);
+        send_displs[r] = std::max(0, a - old_start[rank]);
+        a = std::max(new_start[rank], old_start[r]);
+        b = std::min(new_start[rank + 1], old_start[r + 1]);
+        recv_counts[r] = std::max(0, b - a);
+        recv_displs[r] = std::max(0, a - new_start[rank]);
+    }
+
+    double* moved = allocAligned((size_t)std::max(new_rows[rank], 1) * ysize);
+    MPI_Datatype row_type = rowType(ysize);
+    MPI_Alltoallv(strip, &send_counts[0], &send_displs[0], row_type,
+                  moved, &recv_counts[0], &recv_displs[0], row_type, comm);
+    MPI_Type_free(&row_type);
+    freeAligned(strip);
+    strip = moved;
+    local_rows = new_rows[rank];
+}
@@ -0,0 +1,33 @@
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+// Load balancing of the MPI row strips. Strips start from per-rank weights (or evenly), then
+// every `every` sweeps each rank's update rate is measured and the rows are repartitioned in
+// proportion to the rates when the slowest rank lags a balanced split by more than threshold.
+struct BalanceOptions {
+    int every;                   // Sweeps between rate measurements, 0 keeps the initial split
+    double threshold;            // Allowed excess of the slowest rank over a balanced split
+    std::vector<double> weights; // Initial relative speed per rank, empty for an even split
+    int migrations;              // Out: repartitions done in the last solve
+    std::vector<int> rows;       // Out: rows per rank at the end of the last solve
+};
+
+// Relative speed of every rank of comm from a weights file. Each line is "<name> <weight>",
+// where name is a rank number or a host name (MPI_Get_processor_name) that applies to every
+// rank on that host; rank lines win, unlisted ranks get 1. Collective, empty if unreadable.
+std::vector<double> readBalanceWeights(const std::string& path, MPI_Comm comm);
+
+// Split total rows in proportion to weights, at least min_rows each
+std::vector<int> partitionRows(int total, const std::vector<double>& weights, int min_rows);
+
+// Move a strip layout from old_rows to new_rows rows per rank. Strips stay contiguous and in rank
+// order, so rows only move across shifted boundaries, mostly between neighbours. strip must come
+// from allocAligned and is replaced by a new allocation; local_rows is updated. Collective.
+void migrateRows(double*& strip, int& local_rows, const std::vector<int>& old_rows,
+                 const std::vector<int>& new_rows, int ysize, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,182 @@
+// Including Packages
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <mpi.h>
+#include "Benchmark.h"
+
+const char* scalingModeName(ScalingMode mode) {
+    return mode == SCALING_WEAK ? "weak" : "strong";
+}
+
+bool parseScalingMode(const std::string& name, ScalingMode& mode) {
+    if (name == "strong") mode = SCALING_STRONG;
+    else if (name == "weak") mode = SCALING_WEAK;
+    else return false;
+    return true;
+}
+
+std::vector<int> parseIntList(const std::string& list) {
+    std::vector<int> values;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int value = std::atoi(item.c_str());
+        if (value > 0) values.push_back(value);
+    }
+    return values;
+}
+
+static std::vector<int> rankCounts(const BenchmarkOptions& opts, int world_size) {
+    std::vector<int> counts;
+    for (size_t i = 0; i < opts.rank_counts.size(); i++) {
+        if (opts.rank_counts[i] <= world_size) counts.push_back(opts.rank_counts[i]);
+    }
+    if (opts.rank_counts.empty()) {
+        for (int p = 1; p < world_size; p *= 2) counts.push_back(p);
+        counts.push_back(world_size);
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+// Median, minimum and sample standard deviation of the repetition times
+static void summarize(BenchmarkResult& r) {
+    std::vector<double> sorted = r.times;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    r.median = (n % 2 == 1) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    r.min = sorted[0];
+    double mean = 0.0;
+    for (size_t i = 0; i < n; i++) mean += sorted[i];
+    mean /= n;
+    double var = 0.0;
+    for (size_t i = 0; i < n; i++) var += (sorted[i] - mean) * (sorted[i] - mean);
+    r.stddev = (n > 1) ? std::sqrt(var / (n - 1)) : 0.0;
+
+    double updates = (double)(r.xsize - 2) * (r.ysize - 2) * r.iterations;
+    r.mlups = (r.median > 0.0) ? updates / r.median / 1e6 : 0.0;
+    r.bandwidth = r.mlups * BENCH_BYTES_PER_UPDATE / 1e3;
+}
+
+std::vector<BenchmarkResult> runBenchmark(const BenchmarkOptions& opts, const BenchmarkSolver& solver, MPI_Comm world) {
+    int rank, world_size;
+    MPI_Comm_rank(world, &rank);
+    MPI_Comm_size(world, &world_size);
+    std::vector<int> ranks = rankCounts(opts, world_size);
+    int reps = std::max(1, opts.repetitions);
+
+    std::vector<BenchmarkResult> results;
+    for (size_t c = 0; c < ranks.size(); c++) {
+        int p = ranks[c];
+        // Ranks outside the first p wait at the barrier below
+        MPI_Comm comm;
+        MPI_Comm_split(world, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+        for (size_t s = 0; comm != MPI_COMM_NULL && s < opts.sizes.size(); s++) {
+            int n = opts.sizes[s];
+            int xsize = (opts.scaling == SCALING_WEAK) ? n * p : n;
+            for (size_t t = 0; t < opts.thread_counts.size(); t++) {
+                int threads = opts.thread_counts[t];
+                for (int w = 0; w < opts.warmup; w++) {
+                    solver(comm, xsize, n, opts.iterations, threads);
+                }
+                BenchmarkResult r;
+                r.ranks = p;
+                r.threads = threads;
+                r.xsize = xsize;
+                r.ysize = n;
+                r.iterations = opts.iterations;
+                r.efficiency = 1.0;
+                for (int i = 0; i < reps; i++) {
+                    double local = solver(comm, xsize, n, opts.iterations, threads);
+                    double slowest = 0.0;
+                    MPI_Reduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+                    r.times.push_back(slowest);
+                }
+                if (rank == 0) {
+                    summarize(r);
+                    results.push_back(r);
+                }
+            }
+        }
+        if (comm != MPI_COMM_NULL) MPI_Comm_free(&comm);
+        MPI_Barrier(world);
+    }
+
+    // Efficiency against the first (smallest) rank count that ran the same size and threads
+    for (size_t i = 0; i < results.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            const BenchmarkResult& base = results[j];
+            if (base.ysize != results[i].ysize || base.threads != results[i].threads) continue;
+            double ratio = base.median / results[i].median;
+            results[i].efficiency = (opts.scaling == SCALING_STRONG) ? ratio * base.ranks / results[i].ranks : ratio;
+            break;
+        }
+    }
+    return results;
+}
+
+void printBenchmark(const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results) {
+    std::cout << "\n" << (opts.scaling == SCALING_WEAK ? "Weak" : "Strong") << " scaling, " << opts.iterations
+              << " sweeps, " << opts.warmup << " warmup + " << opts.repetitions << " timed repetitions ("
+              << opts.label << ")\n";
+    std::cout << std::left << std::setw(6) << "Ranks" << std::setw(5) << "Thr" << std::setw(12) << "Grid"
+              << std::right << std::setw(10) << "Median(s)" << std::setw(10) << "Min(s)" << std::setw(10) << "Std(s)"
+              << std::setw(10) << "MLUP/s" << std::setw(8) << "Eff" << std::setw(9) << "GB/s" << "\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        std::stringstream grid;
+        grid << r.xsize << "x" << r.ysize;
+        std::cout << std::left << std::setw(6) << r.ranks << std::setw(5) << r.threads << std::setw(12) << grid.str()
+                  << std::right << std::fixed << std::setprecision(4) << std::setw(10) << r.median
+                  << std::setw(10) << r.min << std::setw(10) << r.stddev
+                  << std::setprecision(1) << std::setw(10) << r.mlups
+                  << std::setprecision(2) << std::setw(8) << r.efficiency
+                  << std::setw(9) << r.bandwidth << "\n";
+    }
+}
+
+bool writeBenchmarkJSON(const std::string& path, const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file(path.c_str());
+    if (!file) return false;
+    file << std::setprecision(9);
+    file << "{\n  \"scaling\": \"" << scalingModeName(opts.scaling) << "\",\n"
+         << "  \"label\": \"" << opts.label << "\",\n"
+         << "  \"iterations\": " << opts.iterations << ",\n"
+         << "  \"warmup\": " << opts.warmup << ",\n"
+         << "  \"repetitions\": " << opts.repetitions << ",\n"
+         << "  \"bytes_per_update\": " << BENCH_BYTES_PER_UPDATE << ",\n"
+         << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        file << "    {\"ranks\": " << r.ranks << ", \"threads\": " << r.threads
+             << ", \"xsize\": " << r.xsize << ", \"ysize\": " << r.ysize
+             << ", \"median_s\": " << r.median << ", \"min_s\": " << r.min << ", \"stddev_s\": " << r.stddev
+             << ", \"mlups\": " << r.mlups << ", \"efficiency\": " << r.efficiency
+             << ", \"bandwidth_gbs\": " << r.bandwidth << ", \"times_s\": [";
+        for (size_t k = 0; k < r.times.size(); k++) file << (k ? ", " : "") << r.times[k];
+        file << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return true;
+}
+
+bool writeBenchmarkCSV(const std::string& path, const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file(path.c_str());
+    if (!file) return false;
+    file << std::setprecision(9);
+    file << "scaling,label,ranks,threads,xsize,ysize,iterations,repetitions,median_s,min_s,stddev_s,mlups,efficiency,bandwidth_gbs\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        file << scalingModeName(opts.scaling) << "," << opts.label << "," << r.ranks << "," << r.threads << ","
+             << r.xsize << "," << r.ysize << "," << r.iterations << "," << r.times.size() << ","
+             << r.median << "," << r.min << "," << r.stddev << "," << r.mlups << ","
+             << r.efficiency << "," << r.bandwidth << "\n";
+    }
+    return true;
+}
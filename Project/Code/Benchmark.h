@@ -0,0 +1,67 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mpi.h>
+
+// Strong scaling keeps the global grid fixed, weak scaling keeps the grid per rank fixed
+enum ScalingMode {
+    SCALING_STRONG,
+    SCALING_WEAK
+};
+
+const char* scalingModeName(ScalingMode mode);
+bool parseScalingMode(const std::string& name, ScalingMode& mode);
+
+// Comma separated list of positive integers, e.g. "1,2,4"
+std::vector<int> parseIntList(const std::string& list);
+
+// Strong scaling solves n x n grids; weak scaling gives every rank an n x n strip, so p ranks
+// solve an (n*p) x n grid. Each rank count runs on the first ranks of MPI_COMM_WORLD.
+struct BenchmarkOptions {
+    ScalingMode scaling;
+    std::vector<int> sizes;
+    std::vector<int> rank_counts;   // Empty: powers of two up to the world size, and the world size
+    std::vector<int> thread_counts; // OpenMP threads per rank
+    int iterations;                 // Sweeps per repetition
+    int warmup;                     // Untimed repetitions before the timed ones
+    int repetitions;
+    std::string label;              // Solver configuration, copied into the JSON/CSV records
+    std::string json_path;
+    std::string csv_path;
+};
+
+// Statistics of one (ranks, threads, size) configuration over the timed repetitions
+struct BenchmarkResult {
+    int ranks;
+    int threads;
+    int xsize;
+    int ysize;
+    int iterations;
+    double median;     // Seconds, slowest rank of each repetition
+    double min;
+    double stddev;
+    double mlups;      // Million interior point updates per second at the median time
+    double efficiency; // Against the smallest rank count with the same size and threads
+    double bandwidth;  // GB/s at BENCH_BYTES_PER_UPDATE
+    std::vector<double> times;
+};
+
+// Minimum memory traffic of one Jacobi update: one double loaded, one stored
+const int BENCH_BYTES_PER_UPDATE = 16;
+
+// Runs iterations sweeps of an xsize x ysize grid on comm and returns this rank's seconds.
+// Setup and teardown are not timed; the slowest rank's time is what gets recorded.
+typedef std::function<double(MPI_Comm comm, int xsize, int ysize, int iterations, int numThreads)> BenchmarkSolver;
+
+// Collective over world (the first p of its ranks run p-rank cases), results are complete on rank 0 only
+std::vector<BenchmarkResult> runBenchmark(const BenchmarkOptions& opts, const BenchmarkSolver& solver,
+                                          MPI_Comm world = MPI_COMM_WORLD);
+
+void printBenchmark(const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results);
+bool writeBenchmarkJSON(const std::string& path, const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results);
+bool writeBenchmarkCSV(const std::string& path, const BenchmarkOptions& opts, const std::vector<BenchmarkResult>& results);
+
+#endif
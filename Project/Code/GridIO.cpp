@@ -0,0 +1,243 @@
+// Including Packages
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <mpi.h>
+#include "GridIO.h"
+#include "Precision.h"
+
+// File element type of a grid element type
+template <typename T> static int gridDType();
+template <> int gridDType<double>() { return GRID_FLOAT64; }
+template <> int gridDType<float>() { return GRID_FLOAT32; }
+
+static GridFileHeader makeHeader(int dtype, int global_xsize, int ysize, int iterations) {
+    GridFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::strcpy(header.magic, "LAPGRID");
+    header.dtype = dtype;
+    header.header_bytes = GRID_HEADER_BYTES;
+    header.xsize = global_xsize;
+    header.ysize = ysize;
+    header.iterations = iterations;
+    return header;
+}
+
+// Point the file view at this rank's block of the global grid; empty blocks get a plain view
+// so they can still take part in the collective calls
+static void setBlockView(MPI_File fh, MPI_Datatype element, int x0, int lx, int y0, int ly, int global_xsize, int ysize) {
+    if (lx > 0 && ly > 0) {
+        int sizes[2] = {global_xsize, ysize};
+        int subsizes[2] = {lx, ly};
+        int starts[2] = {x0, y0};
+        MPI_Datatype file_type;
+        MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, element, &file_type);
+        MPI_Type_commit(&file_type);
+        MPI_File_set_view(fh, GRID_HEADER_BYTES, element, file_type, "native", MPI_INFO_NULL);
+        MPI_Type_free(&file_type);
+    } else {
+        MPI_File_set_view(fh, GRID_HEADER_BYTES, element, element, "native", MPI_INFO_NULL);
+    }
+}
+
+template <typename T>
+double writeGridMPIIO(const char* filename, const T* block, int ld, int x0, int lx, int y0, int ly,
+                      int global_xsize, int ysize, int iterations, MPI_Comm comm) {
+    double start = MPI_Wtime();
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    MPI_File fh;
+    MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    MPI_File_set_size(fh, 0);
+
+    GridFileHeader header = makeHeader(gridDType<T>(), global_xsize, ysize, iterations);
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, &header, GRID_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    // The memory type skips the rest of each local row
+    setBlockView(fh, mpiType<T>(), x0, lx, y0, ly, global_xsize, ysize);
+    if (lx > 0 && ly > 0) {
+        MPI_Datatype memory_type;
+        MPI_Type_vector(lx, ly, ld, mpiType<T>(), &memory_type);
+        MPI_Type_commit(&memory_type);
+        MPI_File_write_at_all(fh, 0, block, 1, memory_type, MPI_STATUS_IGNORE);
+        MPI_Type_free(&memory_type);
+    } else {
+        MPI_File_write_at_all(fh, 0, block, 0, mpiType<T>(), MPI_STATUS_IGNORE);
+    }
+
+    MPI_File_close(&fh);
+    return MPI_Wtime() - start;
+}
+
+double writeGrid3DMPIIO(const char* filename, const double* block, int ldy, int ldz, int x0, int lx, int y0, int ly,
+                        int z0, int lz, int nx, int ny, int nz, int iterations, MPI_Comm comm) {
+    double start = MPI_Wtime();
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    MPI_File fh;
+    MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    MPI_File_set_size(fh, 0);
+
+    GridFileHeader header = makeHeader(GRID_FLOAT64, nx, ny, iterations);
+    header.zsize = nz;
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, &header, GRID_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    // The same subarray shape picks the block out of the file and out of the padded local array
+    if (lx > 0 && ly > 0 && lz > 0) {
+        int subsizes[3] = {lx, ly, lz};
+        int sizes[3] = {nx, ny, nz};
+        int starts[3] = {x0, y0, z0};
+        int local_sizes[3] = {lx, ldy, ldz};
+        int local_starts[3] = {0, 0, 0};
+        MPI_Datatype file_type, memory_type;
+        MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &file_type);
+        MPI_Type_create_subarray(3, local_sizes, subsizes, local_starts, MPI_ORDER_C, MPI_DOUBLE, &memory_type);
+        MPI_Type_commit(&file_type);
+        MPI_Type_commit(&memory_type);
+        MPI_File_set_view(fh, GRID_HEADER_BYTES, MPI_DOUBLE, file_type, "native", MPI_INFO_NULL);
+        MPI_File_write_at_all(fh, 0, block, 1, memory_type, MPI_STATUS_IGNORE);
+        MPI_Type_free(&file_type);
+        MPI_Type_free(&memory_type);
+    } else {
+        MPI_File_set_view(fh, GRID_HEADER_BYTES, MPI_DOUBLE, MPI_DOUBLE, "native", MPI_INFO_NULL);
+        MPI_File_write_at_all(fh, 0, block, 0, MPI_DOUBLE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_File_close(&fh);
+    return MPI_Wtime() - start;
+}
+
+template <typename T>
+void startGridWrite(AsyncGridWrite& w, const char* filename, const T* block, int ld, int x0, int lx, int y0, int ly,
+                    int global_xsize, int ysize, int iterations, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    w.comm = comm;
+    w.header = makeHeader(gridDType<T>(), global_xsize, ysize, iterations);
+
+    size_t count = (size_t)std::max(0, lx) * std::max(0, ly);
+    w.buffer = new char[(count > 0 ? count : 1) * sizeof(T)];
+    T* copy = reinterpret_cast<T*>(w.buffer);
+    for (int x = 0; x < lx; x++) {
+        std::copy(block + (size_t)x * ld, block + (size_t)x * ld + ly, copy + (size_t)x * ly);
+    }
+
+    MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &w.fh);
+    if (rank == 0) {
+        GridFileHeader incomplete = w.header;
+        incomplete.iterations = -1;
+        MPI_File_write_at(w.fh, 0, &incomplete, GRID_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    setBlockView(w.fh, mpiType<T>(), x0, lx, y0, ly, global_xsize, ysize);
+    // Counted in rows, so blocks of more than 2^31 elements are still one request
+    if (count > 0) {
+        MPI_Datatype row_type;
+        MPI_Type_contiguous(ly, mpiType<T>(), &row_type);
+        MPI_Type_commit(&row_type);
+        MPI_File_iwrite_at_all(w.fh, 0, w.buffer, lx, row_type, &w.request);
+        MPI_Type_free(&row_type);
+    } else {
+        MPI_File_iwrite_at_all(w.fh, 0, w.buffer, 0, mpiType<T>(), &w.request);
+    }
+    w.pending = true;
+}
+
+void finishGridWrite(AsyncGridWrite& w) {
+    if (!w.pending) return;
+    int rank;
+    MPI_Comm_rank(w.comm, &rank);
+    MPI_Wait(&w.request, MPI_STATUS_IGNORE);
+    MPI_File_sync(w.fh);
+    // Offsets are relative to the view, so go back to a plain byte view for the header
+    MPI_File_set_view(w.fh, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+    if (rank == 0) {
+        MPI_File_write_at(w.fh, 0, &w.header, GRID_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    MPI_File_close(&w.fh);
+    delete[] w.buffer;
+    w.buffer = NULL;
+    w.pending = false;
+}
+
+int gridFileIterations(const char* filename, int global_xsize, int ysize, MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    int iterations = -1;
+    if (rank == 0) {
+        MPI_File fh;
+        if (MPI_File_open(MPI_COMM_SELF, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) == MPI_SUCCESS) {
+            GridFileHeader header;
+            MPI_Status status;
+            int bytes = 0;
+            MPI_File_read_at(fh, 0, &header, GRID_HEADER_BYTES, MPI_BYTE, &status);
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            if (bytes == GRID_HEADER_BYTES && std::strcmp(header.magic, "LAPGRID") == 0 &&
+                (header.dtype == GRID_FLOAT64 || header.dtype == GRID_FLOAT32) &&
+                header.xsize == global_xsize && header.ysize == ysize && header.zsize == 0) {
+                iterations = (int)header.iterations;
+            }
+            MPI_File_close(&fh);
+        }
+    }
+    MPI_Bcast(&iterations, 1, MPI_INT, 0, comm);
+    return iterations;
+}
+
+// Read this rank's block in the file's own element type F and convert it to T
+template <typename F, typename T>
+static void readBlock(MPI_File fh, T* block, int ld, int x0, int lx, int y0, int ly, int global_xsize, int ysize) {
+    setBlockView(fh, mpiType<F>(), x0, lx, y0, ly, global_xsize, ysize);
+    size_t count = (size_t)std::max(0, lx) * std::max(0, ly);
+    std::vector<F> rows(count > 0 ? count : 1);
+    if (count > 0) {
+        MPI_Datatype row_type;
+        MPI_Type_contiguous(ly, mpiType<F>(), &row_type);
+        MPI_Type_commit(&row_type);
+        MPI_File_read_at_all(fh, 0, &rows[0], lx, row_type, MPI_STATUS_IGNORE);
+        MPI_Type_free(&row_type);
+    } else {
+        MPI_File_read_at_all(fh, 0, &rows[0], 0, mpiType<F>(), MPI_STATUS_IGNORE);
+    }
+    for (int x = 0; x < lx; x++) {
+        std::copy(&rows[0] + (size_t)x * ly, &rows[0] + (size_t)(x + 1) * ly, block + (size_t)x * ld);
+    }
+}
+
+template <typename T>
+void readGridMPIIO(const char* filename, T* block, int ld, int x0, int lx, int y0, int ly,
+                   int global_xsize, int ysize, MPI_Comm comm) {
+    MPI_File fh;
+    MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    GridFileHeader header;
+    MPI_File_read_at_all(fh, 0, &header, GRID_HEADER_BYTES, MPI_BYTE, MPI_STATUS_IGNORE);
+    if (header.dtype == gridDType<T>()) {
+        setBlockView(fh, mpiType<T>(), x0, lx, y0, ly, global_xsize, ysize);
+        if (lx > 0 && ly > 0) {
+            MPI_Datatype memory_type;
+            MPI_Type_vector(lx, ly, ld, mpiType<T>(), &memory_type);
+            MPI_Type_commit(&memory_type);
+            MPI_File_read_at_all(fh, 0, block, 1, memory_type, MPI_STATUS_IGNORE);
+            MPI_Type_free(&memory_type);
+        } else {
+            MPI_File_read_at_all(fh, 0, block, 0, mpiType<T>(), MPI_STATUS_IGNORE);
+        }
+    } else if (header.dtype == GRID_FLOAT32) {
+        readBlock<float>(fh, block, ld, x0, lx, y0, ly, global_xsize, ysize);
+    } else {
+        readBlock<double>(fh, block, ld, x0, lx, y0, ly, global_xsize, ysize);
+    }
+    MPI_File_close(&fh);
+}
+
+template double writeGridMPIIO<double>(const char*, const double*, int, int, int, int, int, int, int, int, MPI_Comm);
+template double writeGridMPIIO<float>(const char*, const float*, int, int, int, int, int, int, int, int, MPI_Comm);
+template void startGridWrite<double>(AsyncGridWrite&, const char*, const double*, int, int, int, int, int, int, int, int, MPI_Comm);
+template void startGridWrite<float>(AsyncGridWrite&, const char*, const float*, int, int, int, int, int, int, int, int, MPI_Comm);
+template void readGridMPIIO<double>(const char*, double*, int, int, int, int, int, int, int, MPI_Comm);
+template void readGridMPIIO<float>(const char*, float*, int, int, int, int, int, int, int, MPI_Comm);
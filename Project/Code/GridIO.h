@@ -0,0 +1,68 @@
+#ifndef GRID_IO_H
+#define GRID_IO_H
+
+#include <cstdint>
+#include <mpi.h>
+
+// Element types a binary grid file can hold
+enum GridDType {
+    GRID_FLOAT64 = 1,
+    GRID_FLOAT32 = 2
+};
+
+// Binary grid file: this 64-byte header, then the xsize x ysize grid in row-major order
+// (xsize x ysize x zsize for a 3D grid)
+struct GridFileHeader {
+    char magic[8];        // "LAPGRID" and a terminating zero
+    int32_t dtype;        // GridDType of the elements
+    int32_t header_bytes; // Offset of the first element
+    int64_t xsize;
+    int64_t ysize;
+    int64_t iterations;   // Sweeps that produced the grid, -1 while the data is being written
+    int64_t zsize;        // 0 for 2D grids
+    char reserved[16];
+};
+
+const int GRID_HEADER_BYTES = sizeof(GridFileHeader);
+
+// Collectively write a distributed grid into one file with MPI_File_write_at_all. Each rank passes
+// its lx x ly block at global offset (x0, y0), stored with row length ld; rank 0 of comm writes the
+// header. The file holds the block's element type (float or double). Returns the seconds this rank
+// spent in the write.
+template <typename T>
+double writeGridMPIIO(const char* filename, const T* block, int ld, int x0, int lx, int y0, int ly,
+                      int global_xsize, int ysize, int iterations, MPI_Comm comm);
+
+// The same write in the background with MPI_File_iwrite_at_all. The block is copied first so the
+// caller can keep updating it; the header only gets the iteration count once finishGridWrite has
+// seen all data reach the file, so an interrupted write never looks complete.
+struct AsyncGridWrite {
+    MPI_File fh;
+    MPI_Request request;
+    MPI_Comm comm;
+    char* buffer;
+    GridFileHeader header;
+    bool pending;
+};
+
+template <typename T>
+void startGridWrite(AsyncGridWrite& w, const char* filename, const T* block, int ld, int x0, int lx, int y0, int ly,
+                    int global_xsize, int ysize, int iterations, MPI_Comm comm);
+void finishGridWrite(AsyncGridWrite& w);
+
+// Collectively write a distributed 3D grid of doubles. Each rank passes its lx x ly x lz block at
+// global offset (x0, y0, z0), stored as planes of ldy rows of ldz points.
+double writeGrid3DMPIIO(const char* filename, const double* block, int ldy, int ldz, int x0, int lx, int y0, int ly,
+                        int z0, int lz, int nx, int ny, int nz, int iterations, MPI_Comm comm);
+
+// Sweep count of a complete 2D grid file of the given size and either element type, -1 if the file
+// is missing, incomplete or holds another size. Collective over comm.
+int gridFileIterations(const char* filename, int global_xsize, int ysize, MPI_Comm comm);
+
+// Collectively read each rank's block (same arguments as writeGridMPIIO) from a grid file,
+// converting the file's element type to the block's
+template <typename T>
+void readGridMPIIO(const char* filename, T* block, int ld, int x0, int lx, int y0, int ly,
+                   int global_xsize, int ysize, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef LAPLACE_H
+#define LAPLACE_H
+
+#include <mpi.h>
+
+// Grid helpers shared by the solvers (defined in MPILaplace.cpp, for double and float grids)
+template <typename T> void initializeGrid(T* grid, int xsize, int ysize, int numThreads = 1);
+template <typename T> void initializeRows(T* rows, int row0, int nrows, int xsize, int ysize);
+double diffMat(double* M1, double* M2, int rows, int cols);
+double diffMat(float* M1, double* M2, int rows, int cols);
+
+// Split n points into parts nearly even blocks; block idx is [start, start+len)
+void blockRange(int n, int parts, int idx, int& start, int& len);
+
+// Committed datatype for one row of ysize elements; strip scatters and gathers count rows
+// so they work for strips of more than 2^31 elements. Free it with MPI_Type_free.
+MPI_Datatype rowType(int ysize, MPI_Datatype element = MPI_DOUBLE);
+
+#endif
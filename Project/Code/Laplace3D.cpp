@@ -0,0 +1,262 @@
+// Including Packages
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+#include <mpi.h>
+#include "Laplace.h"
+#include "Laplace3D.h"
+#include "Simd.h"
+#include "GridIO.h"
+
+void initializeBlock3D(double* block, int ldy, int ldz, int x0, int lx, int ly, int lz, int nx) {
+    for (int x = 0; x < lx; x++) {
+        int gx = x0 + x;
+        double value = (gx == 0) ? 5.0 : (gx == nx - 1) ? -5.0 : 0.0; // The other faces and the inside are 0
+        for (int y = 0; y < ly; y++) {
+            double* row = block + ((size_t)x * ldy + y) * ldz;
+            std::fill(row, row + lz, value);
+        }
+    }
+}
+
+int autoTileRows(int ldz) {
+    // A plane of a tile reads the tile's rows in three planes (plus a row on either side) and writes one
+    const size_t cache_bytes = 256 << 10;
+    int rows = (int)(cache_bytes / (4 * sizeof(double) * (size_t)ldz)) - 2;
+    return std::max(rows, 1);
+}
+
+// Jacobi update of the inclusive box [xa,xb] x [ya,yb] x [za,zb] of a block stored as planes of
+// ldy rows of ldz points. The y range is cut into tiles of tile rows and each tile is swept through
+// all its planes before the next one, so the planes a row reads are still cached for the next plane.
+static void sweepBox(double* u, const double* uu, int xa, int xb, int ya, int yb, int za, int zb,
+                     int ldy, int ldz, int tile, int numThreads) {
+    if (xb < xa || yb < ya || zb < za) return;
+    size_t plane = (size_t)ldy * ldz;
+    int tiles = (yb - ya) / tile + 1;
+    #pragma omp parallel for collapse(2) schedule(static) num_threads(numThreads) proc_bind(close) if(numThreads > 1)
+    for (int t = 0; t < tiles; t++) {
+        for (int x = xa; x <= xb; x++) {
+            int y_end = std::min(yb, ya + (t + 1) * tile - 1);
+            for (int y = ya + t * tile; y <= y_end; y++) {
+                size_t i = x * plane + (size_t)y * ldz;
+                stencilRow7(u + i, uu + i - plane, uu + i + plane, uu + i - ldz, uu + i + ldz, uu + i, za, zb + 1);
+            }
+        }
+    }
+}
+
+void serialLaplace3D(double* u, double* uu, int nx, int ny, int nz, int iter) {
+    size_t count = (size_t)nx * ny * nz;
+    std::copy(u, u + count, uu);
+    double* cur = u;
+    double* next = uu;
+    int tile = autoTileRows(nz);
+    for (int i = 0; i < iter; i++) {
+        sweepBox(next, cur, 1, nx - 2, 1, ny - 2, 1, nz - 2, ny, nz, tile, 1);
+        std::swap(cur, next);
+    }
+    if (cur != u) std::copy(cur, cur + count, u);
+}
+
+// Pick a 3D process grid that fits the grid; returns how many ranks it uses, as cartDims does in 2D
+static int cartDims3D(int size, int nx, int ny, int nz, int dims[3]) {
+    for (int active = size; active > 1; active--) {
+        dims[0] = dims[1] = dims[2] = 0;
+        MPI_Dims_create(active, 3, dims);
+        if (dims[0] <= nx && dims[1] <= ny && dims[2] <= nz) return active;
+    }
+    dims[0] = dims[1] = dims[2] = 1;
+    return 1;
+}
+
+double mpiLaplace3D(int nx, int ny, int nz, int iter, int rank, int size, const double* reference,
+                    const Laplace3DOptions& opts, int numThreads, const char* output, double* write_time,
+                    PhaseTimers* timers, MPI_Comm comm, bool reorder) {
+    int check = (rank == 0 && reference) ? 1 : 0;
+    MPI_Bcast(&check, 1, MPI_INT, 0, comm);
+
+    int dims[3], periods[3] = {0, 0, 0};
+    int active = cartDims3D(size, nx, ny, nz, dims);
+    MPI_Comm members, cart = MPI_COMM_NULL;
+    MPI_Comm_split(comm, rank < active ? 0 : MPI_UNDEFINED, rank, &members);
+    if (members != MPI_COMM_NULL) {
+        MPI_Cart_create(members, 3, dims, periods, reorder ? 1 : 0, &cart);
+        MPI_Comm_free(&members);
+    }
+
+    double diff = 0.0;
+    if (cart != MPI_COMM_NULL) {
+        int cart_rank, cart_size, coords[3];
+        MPI_Comm_rank(cart, &cart_rank);
+        MPI_Comm_size(cart, &cart_size);
+        MPI_Cart_coords(cart, cart_rank, 3, coords);
+        int root, mine = (rank == 0) ? cart_rank : -1;
+        MPI_Allreduce(&mine, &root, 1, MPI_INT, MPI_MAX, cart);
+
+        int start[3], extent[3];
+        int global[3] = {nx, ny, nz};
+        for (int d = 0; d < 3; d++) blockRange(global[d], dims[d], coords[d], start[d], extent[d]);
+        int lx = extent[0], ly = extent[1], lz = extent[2];
+        // Ghost layers on all six sides; rows padded to whole 64-byte vectors as in 2D
+        int ldy = ly + 2;
+        int ldz = paddedRow(lz + 2);
+        size_t plane = (size_t)ldy * ldz;
+        size_t count = (size_t)(lx + 2) * plane;
+        int layout[3] = {lx + 2, ldy, ldz};
+
+        phaseStart(timers);
+        double* u = allocAligned(count);
+        double* uu = allocAligned(count);
+        std::fill(u, u + count, 0.0);
+        initializeBlock3D(u + plane + ldz + 1, ldy, ldz, start[0], lx, ly, lz, nx);
+        std::copy(u, u + count, uu);
+        phaseEnd(timers, PHASE_COPY);
+
+        // Per dimension, the low and high face this block sends and the ghost layers it receives
+        MPI_Datatype send_type[3][2], recv_type[3][2];
+        int low[3], high[3];
+        for (int d = 0; d < 3; d++) {
+            for (int side = 0; side < 2; side++) {
+                int subsizes[3] = {lx, ly, lz};
+                int starts[3] = {1, 1, 1};
+                subsizes[d] = 1;
+                starts[d] = side ? extent[d] : 1;
+                MPI_Type_create_subarray(3, layout, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &send_type[d][side]);
+                starts[d] = side ? extent[d] + 1 : 0;
+                MPI_Type_create_subarray(3, layout, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &recv_type[d][side]);
+                MPI_Type_commit(&send_type[d][side]);
+                MPI_Type_commit(&recv_type[d][side]);
+            }
+            MPI_Cart_shift(cart, d, 1, &low[d], &high[d]);
+        }
+
+        // All twelve messages of one exchange; a tag names the side of the receiving ghost layer
+        double* buffers[2] = {u, uu};
+        MPI_Request requests[2][12];
+        bool overlap = opts.overlap || opts.persistent;
+        if (opts.persistent) {
+            for (int b = 0; b < 2; b++) {
+                for (int d = 0; d < 3; d++) {
+                    MPI_Recv_init(buffers[b], 1, recv_type[d][0], low[d], 2 * d, cart, &requests[b][4 * d]);
+                    MPI_Recv_init(buffers[b], 1, recv_type[d][1], high[d], 2 * d + 1, cart, &requests[b][4 * d + 1]);
+                    MPI_Send_init(buffers[b], 1, send_type[d][1], high[d], 2 * d, cart, &requests[b][4 * d + 2]);
+                    MPI_Send_init(buffers[b], 1, send_type[d][0], low[d], 2 * d + 1, cart, &requests[b][4 * d + 3]);
+                }
+            }
+        }
+
+        // Points to update, skipping the global boundary, and the part of them that reads no ghost layer
+        int xa = (start[0] == 0) ? 2 : 1, xb = (start[0] + lx == nx) ? lx - 1 : lx;
+        int ya = (start[1] == 0) ? 2 : 1, yb = (start[1] + ly == ny) ? ly - 1 : ly;
+        int za = (start[2] == 0) ? 2 : 1, zb = (start[2] + lz == nz) ? lz - 1 : lz;
+        int ra = std::max(xa, 2), rb = std::min(xb, lx - 1);
+        int sa = std::max(ya, 2), sb = std::min(yb, ly - 1);
+        int ta = std::max(za, 2), tb = std::min(zb, lz - 1);
+        int tile = (opts.tile_rows > 0) ? opts.tile_rows : autoTileRows(ldz);
+
+        for (int i = 0; i < iter; i++) {
+            double sweep_begin = 0.0;
+            if (timers) {
+                sweep_begin = timers->mark;
+                timers->iteration = i + 1;
+            }
+            double* cur = buffers[i % 2];
+            double* next = buffers[(i + 1) % 2];
+            MPI_Request* req = requests[i % 2];
+
+            if (opts.persistent) {
+                MPI_Startall(12, req);
+            } else if (overlap) {
+                for (int d = 0; d < 3; d++) {
+                    MPI_Irecv(cur, 1, recv_type[d][0], low[d], 2 * d, cart, &req[4 * d]);
+                    MPI_Irecv(cur, 1, recv_type[d][1], high[d], 2 * d + 1, cart, &req[4 * d + 1]);
+                    MPI_Isend(cur, 1, send_type[d][1], high[d], 2 * d, cart, &req[4 * d + 2]);
+                    MPI_Isend(cur, 1, send_type[d][0], low[d], 2 * d + 1, cart, &req[4 * d + 3]);
+                }
+            } else {
+                for (int d = 0; d < 3; d++) {
+                    MPI_Sendrecv(cur, 1, send_type[d][1], high[d], 2 * d,
+                                 cur, 1, recv_type[d][0], low[d], 2 * d, cart, MPI_STATUS_IGNORE);
+                    MPI_Sendrecv(cur, 1, send_type[d][0], low[d], 2 * d + 1,
+                                 cur, 1, recv_type[d][1], high[d], 2 * d + 1, cart, MPI_STATUS_IGNORE);
+                }
+            }
+            phaseEnd(timers, overlap ? PHASE_HALO_POST : PHASE_HALO_WAIT);
+
+            if (overlap) {
+                sweepBox(next, cur, ra, rb, sa, sb, ta, tb, ldy, ldz, tile, numThreads);
+                phaseEnd(timers, PHASE_INTERIOR);
+                MPI_Waitall(12, req, MPI_STATUSES_IGNORE);
+                phaseEnd(timers, PHASE_HALO_WAIT);
+                // The shell next to the faces: first/last planes, then first/last rows, then first/last points
+                if (xa == 1) sweepBox(next, cur, 1, std::min(xb, 1), ya, yb, za, zb, ldy, ldz, tile, numThreads);
+                if (lx > 1 && xb == lx) sweepBox(next, cur, lx, lx, ya, yb, za, zb, ldy, ldz, tile, numThreads);
+                if (ya == 1) sweepBox(next, cur, ra, rb, 1, std::min(yb, 1), za, zb, ldy, ldz, tile, numThreads);
+                if (ly > 1 && yb == ly) sweepBox(next, cur, ra, rb, ly, ly, za, zb, ldy, ldz, tile, numThreads);
+                if (za == 1) sweepBox(next, cur, ra, rb, sa, sb, 1, std::min(zb, 1), ldy, ldz, tile, numThreads);
+                if (lz > 1 && zb == lz) sweepBox(next, cur, ra, rb, sa, sb, lz, lz, ldy, ldz, tile, numThreads);
+                phaseEnd(timers, PHASE_EDGE);
+            } else {
+                sweepBox(next, cur, xa, xb, ya, yb, za, zb, ldy, ldz, tile, numThreads);
+                phaseEnd(timers, PHASE_INTERIOR);
+            }
+            if (timers) traceEvent(timers->trace, "iteration", sweep_begin, timers->mark, i + 1);
+        }
+        double* result = buffers[iter % 2];
+
+        if (opts.persistent) {
+            for (int b = 0; b < 2; b++) {
+                for (int r = 0; r < 12; r++) MPI_Request_free(&requests[b][r]);
+            }
+        }
+        for (int d = 0; d < 3; d++) {
+            for (int side = 0; side < 2; side++) {
+                MPI_Type_free(&send_type[d][side]);
+                MPI_Type_free(&recv_type[d][side]);
+            }
+        }
+
+        if (output) {
+            double t = writeGrid3DMPIIO(output, result + plane + ldz + 1, ldy, ldz, start[0], lx, start[1], ly,
+                                        start[2], lz, nx, ny, nz, iter, cart);
+            if (write_time) *write_time = t;
+        }
+        phaseStart(timers);
+
+        // Gather the blocks on the root, each as one subarray message, and compare
+        if (check) {
+            int block_starts[3] = {1, 1, 1};
+            MPI_Datatype block_type;
+            MPI_Type_create_subarray(3, layout, extent, block_starts, MPI_ORDER_C, MPI_DOUBLE, &block_type);
+            MPI_Type_commit(&block_type);
+            MPI_Request send_request;
+            MPI_Isend(result, 1, block_type, root, 1, cart, &send_request);
+            if (cart_rank == root) {
+                std::vector<double> whole((size_t)nx * ny * nz);
+                for (int r = 0; r < cart_size; r++) {
+                    int c[3], bstart[3], bextent[3];
+                    MPI_Cart_coords(cart, r, 3, c);
+                    for (int d = 0; d < 3; d++) blockRange(global[d], dims[d], c[d], bstart[d], bextent[d]);
+                    MPI_Datatype global_block;
+                    MPI_Type_create_subarray(3, global, bextent, bstart, MPI_ORDER_C, MPI_DOUBLE, &global_block);
+                    MPI_Type_commit(&global_block);
+                    MPI_Recv(&whole[0], 1, global_block, r, 1, cart, MPI_STATUS_IGNORE);
+                    MPI_Type_free(&global_block);
+                }
+                phaseEnd(timers, PHASE_GATHER);
+                diff = diffMat(&whole[0], const_cast<double*>(reference), nx * ny, nz);
+                phaseEnd(timers, PHASE_VERIFY);
+            }
+            MPI_Wait(&send_request, MPI_STATUS_IGNORE);
+            MPI_Type_free(&block_type);
+            phaseEnd(timers, PHASE_GATHER);
+        }
+
+        MPI_Comm_free(&cart);
+        freeAligned(u);
+        freeAligned(uu);
+    }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, comm);
+    return diff;
+}
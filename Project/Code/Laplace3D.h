@@ -0,0 +1,41 @@
+#ifndef LAPLACE_3D_H
+#define LAPLACE_3D_H
+
+#include <mpi.h>
+#include "PhaseTimers.h"
+
+// 3D Laplace problem on an nx x ny x nz grid, stored as nx planes of ny rows of nz points: 5 on the
+// x = 0 face, -5 on the x = nx-1 face and 0 on the other faces, all fixed. A 7-point Jacobi sweep
+// (stencilRow7) sets every interior point to the average of its six neighbours.
+
+// Initialize lx planes of ly rows of lz points, global planes [x0, x0+lx), into block, stored as
+// planes of ldy rows of ldz points, so a rank can set up its block alone. The values depend only on
+// the plane, so the block's y and z offsets are not needed.
+void initializeBlock3D(double* block, int ldy, int ldz, int x0, int lx, int ly, int lz, int nx);
+
+// Serial 3D Jacobi solver, u holds the result and uu is scratch
+void serialLaplace3D(double* u, double* uu, int nx, int ny, int nz, int iter);
+
+// How the distributed 3D solver sweeps and exchanges its block
+struct Laplace3DOptions {
+    int tile_rows;   // Rows of a y tile, swept through all planes before the next tile; 0 fits three planes of a tile in L2
+    bool overlap;    // Post all six faces at once and sweep the interior while they travel, else one dimension at a time
+    bool persistent; // Overlapped exchange with persistent requests
+};
+
+// y tile of Laplace3DOptions::tile_rows 0 for rows of ldz points
+int autoTileRows(int ldz);
+
+// 3D Jacobi on a 3D Cartesian process grid (MPI_Dims_create, reordered when reorder is set). Every
+// rank sets up its own ghosted block; the six face halos are sent and received in place with
+// MPI_Type_create_subarray types, and the 7-point stencil needs no edge or corner halos.
+// With reference set (the whole grid, on rank 0 of comm) the blocks are gathered and the difference
+// is returned on every rank, else 0. With output set the result is written to that file
+// (writeGrid3DMPIIO) and the seconds spent go to *write_time. With timers set this rank's time per
+// phase is added to them. rank and size are within comm; ranks the process grid leaves out stay idle.
+double mpiLaplace3D(int nx, int ny, int nz, int iter, int rank, int size, const double* reference,
+                    const Laplace3DOptions& opts, int numThreads = 1, const char* output = NULL,
+                    double* write_time = NULL, PhaseTimers* timers = NULL, MPI_Comm comm = MPI_COMM_WORLD,
+                    bool reorder = false);
+
+#endif
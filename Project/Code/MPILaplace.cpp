@@ -9,6 +9,21 @@
 #include <sstream>
 #include <algorithm>
 #include <string>
+#include <cstdlib>
+#include "Laplace.h"
+#include "Multigrid.h"
+#include "SOR.h"
+#include "TiledLaplace.h"
+#include "Simd.h"
+#include "GridIO.h"
+#include "Benchmark.h"
+#include "PhaseTimers.h"
+#include "Balance.h"
+#include "Placement.h"
+#include "Numa.h"
+#include "Precision.h"
+#include "Problem.h"
+#include "Laplace3D.h"
 
 #define MAX_SIZE 1024
 #define MIN_SIZE 64
@@ -28,152 +43,1278 @@ struct msClock {
 } Clock;
 
 // Initialize grid with boundary conditions
-void initializeGrid(double* grid, int xsize, int ysize) {
-    for (int x = 0; x < xsize; x++) {
+// With numThreads > 1 the rows are first written by the threads that sweep them in openMPLaplace
+// (the same static split of rows 1..xsize-2), so on NUMA machines every page starts out local to them
+template <typename T>
+void initializeGrid(T* grid, int xsize, int ysize, int numThreads) {
+    #pragma omp parallel for num_threads(numThreads) schedule(static) if(numThreads > 1)
+    for (int x = 1; x < xsize - 1; x++) {
+        initializeRows(grid + (size_t)x * ysize, x, 1, xsize, ysize);
+    }
+    initializeRows(grid, 0, 1, xsize, ysize);
+    if (xsize > 1) initializeRows(grid + (size_t)(xsize - 1) * ysize, xsize - 1, 1, xsize, ysize);
+}
+
+// Initialize global rows [row0, row0+rows) of an xsize x ysize grid, so a rank can set up its strip alone
+template <typename T>
+void initializeRows(T* rows_out, int row0, int rows, int xsize, int ysize) {
+    for (int r = 0; r < rows; r++) {
+        int x = row0 + r;
         for (int y = 0; y < ysize; y++) {
-            int idx = x * ysize + y;
-            if (x == 0) grid[idx] = 5.0;             // Top boundary
-            else if (x == xsize-1) grid[idx] = -5.0;  // Bottom boundary
-            else if (y == 0 || y == ysize-1) grid[idx] = 0.0; // Left/Right
-            else grid[idx] = 0.0;                     // Inside grid
+            size_t idx = (size_t)r * ysize + y;
+            if (x == 0) rows_out[idx] = 5.0;             // Top boundary
+            else if (x == xsize-1) rows_out[idx] = -5.0;  // Bottom boundary
+            else if (y == 0 || y == ysize-1) rows_out[idx] = 0.0; // Left/Right
+            else rows_out[idx] = 0.0;                     // Inside grid
         }
     }
 }
 
+// Strips move between ranks as whole rows, so counts and displacements stay far below 2^31
+// even when a strip holds more elements than that
+MPI_Datatype rowType(int ysize, MPI_Datatype element) {
+    MPI_Datatype row_type;
+    MPI_Type_contiguous(ysize, element, &row_type);
+    MPI_Type_commit(&row_type);
+    return row_type;
+}
+
 // Compute difference between sums of two matrices
 double diffMat(double* M1, double* M2, int rows, int cols) {
     double sum1 = 0.0, sum2 = 0.0;
     for (int i = 0; i < rows; i++) {
         for (int j = 0; j < cols; j++) {
-            sum1 += M1[j + i * cols];
-            sum2 += M2[j + i * cols];
+            sum1 += M1[(size_t)i * cols + j];
+            sum2 += M2[(size_t)i * cols + j];
         }
     }
     return std::abs(sum2 - sum1);
 }
 
-// Serial Laplace solver
-void serialLaplace(double* u, double* uu, int xsize, int ysize, int iter) {
+// A float grid is widened first, so the diff measures it against the double reference
+double diffMat(float* M1, double* M2, int rows, int cols) {
+    std::vector<double> wide(M1, M1 + (size_t)rows * cols);
+    return diffMat(wide.data(), M2, rows, cols);
+}
+
+// Difference norms between a distributed solution and its reference
+struct DiffNorms {
+    double sum; // |sum(reference) - sum(solution)|, what diffMat reports
+    double max; // Largest pointwise difference
+    double l2;  // L2 norm of the difference
+};
+
+// Reduction operator for {sum, sum of squares, max}: the first two entries are added and the
+// third takes the max, so all three norms travel in one MPI_Reduce
+void combineDiffNorms(void* in, void* inout, int* len, MPI_Datatype*) {
+    const double* a = static_cast<const double*>(in);
+    double* b = static_cast<double*>(inout);
+    for (int i = 0; i + 2 < *len; i += 3) {
+        b[i] += a[i];
+        b[i+1] += a[i+1];
+        b[i+2] = std::max(b[i+2], a[i+2]);
+    }
+}
+
+// Compare each rank's count values with its part of the reference; the norms are only valid on root
+DiffNorms reduceDiffNorms(const double* local, const double* reference, size_t count, int root, MPI_Comm comm) {
+    double local_norms[3] = {0.0, 0.0, 0.0};
+    for (size_t i = 0; i < count; i++) {
+        double d = reference[i] - local[i];
+        local_norms[0] += d;
+        local_norms[1] += d * d;
+        local_norms[2] = std::max(local_norms[2], std::abs(d));
+    }
+    MPI_Op op;
+    MPI_Op_create(combineDiffNorms, 1, &op);
+    double norms[3] = {0.0, 0.0, 0.0};
+    MPI_Reduce(local_norms, norms, 3, MPI_DOUBLE, op, root, comm);
+    MPI_Op_free(&op);
+    DiffNorms result = {std::abs(norms[0]), norms[2], std::sqrt(norms[1])};
+    return result;
+}
+
+// Update the two end points of a row whose y sides are Neumann (mirrored inner neighbour) or
+// periodic (wrap: the other end of the row)
+template <typename T>
+inline void updateRowEnds(T* out, const T* up, const T* mid, const T* down, int ysize, const T* source, bool wrap) {
+    const T quarter = 0.25;
+    int last = ysize - 1;
+    out[0] = quarter * (up[0] + down[0] + (wrap ? mid[last] : mid[1]) + mid[1]);
+    out[last] = quarter * (up[last] + down[last] + mid[last-1] + (wrap ? mid[0] : mid[last-1]));
+    if (source) {
+        out[0] += source[0];
+        out[last] += source[last];
+    }
+}
+
+// Update one row from the rows above and below it (rows may be halo buffers), plus the row of a
+// source term when there is one. Rows with Dirichlet y sides keep their end points.
+template <typename T>
+inline void updateRow(T* out, const T* up, const T* mid, const T* down, int ysize, const T* source = NULL,
+                      BoundaryKind y_sides = BOUNDARY_DIRICHLET) {
+    stencilRow(out, up, mid, down, source, 1, ysize - 1);
+    if (y_sides != BOUNDARY_DIRICHLET) updateRowEnds(out, up, mid, down, ysize, source, y_sides == BOUNDARY_PERIODIC);
+}
+
+// Neighbour rows of global row x. Rows 0 and xsize-1 are only swept with Neumann x sides, where the
+// missing neighbour is the mirrored inner row, or periodic ones, where it is the other end of the grid.
+inline size_t rowAbove(int x, int xsize, BoundaryKind x_sides) {
+    if (x > 0) return x - 1;
+    return (x_sides == BOUNDARY_PERIODIC) ? xsize - 1 : 1;
+}
+
+inline size_t rowBelow(int x, int xsize, BoundaryKind x_sides) {
+    if (x < xsize - 1) return x + 1;
+    return (x_sides == BOUNDARY_PERIODIC) ? 0 : xsize - 2;
+}
+
+// Serial Laplace solver. u and uu are swapped between sweeps instead of copying u
+// into uu; both carry the boundary values, so only interior points are written.
+// With source set (h^2 f / 4 per point, see Problem) it solves the Poisson problem, and sides other
+// than Dirichlet are swept as well.
+void serialLaplace(double* u, double* uu, int xsize, int ysize, int iter, const double* source = NULL,
+                   Boundaries sides = Boundaries()) {
+    std::copy(u, u + (size_t)xsize * ysize, uu);
+    double* cur = u;
+    double* next = uu;
+    int xa = (sides.x == BOUNDARY_DIRICHLET) ? 1 : 0;
+    int xb = (sides.x == BOUNDARY_DIRICHLET) ? xsize - 1 : xsize;
     for (int i = 0; i < iter; i++) {
-        // Copy u to uu
-        for (int x = 0; x < xsize; x++) {
-            for (int y = 0; y < ysize; y++) {
-                uu[x * ysize + y] = u[x * ysize + y];
-            }
-        }
-        // Update u
-        for (int x = 1; x < xsize - 1; x++) {
-            for (int y = 1; y < ysize - 1; y++) {
-                u[x * ysize + y] = 0.25 * (uu[(x-1) * ysize + y] + uu[(x+1) * ysize + y] +
-                                           uu[x * ysize + (y-1)] + uu[x * ysize + (y+1)]);
-            }
+        // Update next from cur
+        for (int x = xa; x < xb; x++) {
+            updateRow(next + (size_t)x * ysize, cur + rowAbove(x, xsize, sides.x) * ysize, cur + (size_t)x * ysize,
+                      cur + rowBelow(x, xsize, sides.x) * ysize, ysize, source ? source + (size_t)x * ysize : NULL, sides.y);
         }
+        std::swap(cur, next);
     }
+    // After an odd number of sweeps the result sits in uu
+    if (cur != u) std::copy(cur, cur + (size_t)xsize * ysize, u);
 }
 
-// OpenMP Laplace solver
-double openMPLaplace(double* u, double* uu, int xsize, int ysize, int iter, int numThreads, double* serial_u) {
+// OpenMP Laplace solver, on double or float grids; source and sides as in serialLaplace
+template <typename T>
+double openMPLaplace(T* u, T* uu, int xsize, int ysize, int iter, int numThreads, double* serial_u,
+                     const T* source = NULL, Boundaries sides = Boundaries()) {
     omp_set_num_threads(numThreads);
+    // Rows are copied with the sweep's static split, so a fresh uu is first touched where it is used
+    #pragma omp parallel for schedule(static)
+    for (int x = 1; x < xsize - 1; x++) {
+        std::copy(u + (size_t)x * ysize, u + (size_t)(x + 1) * ysize, uu + (size_t)x * ysize);
+    }
+    std::copy(u, u + ysize, uu);
+    std::copy(u + (size_t)(xsize - 1) * ysize, u + (size_t)xsize * ysize, uu + (size_t)(xsize - 1) * ysize);
+    T* cur = u;
+    T* next = uu;
+    int xa = (sides.x == BOUNDARY_DIRICHLET) ? 1 : 0;
+    int xb = (sides.x == BOUNDARY_DIRICHLET) ? xsize - 1 : xsize;
     for (int i = 0; i < iter; i++) {
-        // Copy u to uu
-        #pragma omp parallel for
-        for (int x = 0; x < xsize; x++) {
-            for (int y = 0; y < ysize; y++) {
-                uu[x * ysize + y] = u[x * ysize + y];
+        // Update next from cur
+        #pragma omp parallel for schedule(static)
+        for (int x = xa; x < xb; x++) {
+            updateRow(next + (size_t)x * ysize, cur + rowAbove(x, xsize, sides.x) * ysize, cur + (size_t)x * ysize,
+                      cur + rowBelow(x, xsize, sides.x) * ysize, ysize, source ? source + (size_t)x * ysize : NULL, sides.y);
+        }
+        std::swap(cur, next);
+    }
+    if (cur != u) std::copy(cur, cur + (size_t)xsize * ysize, u);
+    return diffMat(u, serial_u, xsize, ysize);
+}
+
+// Convergence control for the MPI solvers: every check_every sweeps the change between the
+// last two sweeps is reduced over all ranks and the solve stops once it falls below tol
+struct Convergence {
+    double tol;        // Stop below this residual; the solvers run all iterations when it is 0
+    int check_every;   // Sweeps between residual reductions
+    bool use_l2;       // L2 norm of the change instead of the max norm
+    bool overlap;      // Use MPI_Iallreduce and test it one check interval later
+    int iterations;    // Out: sweeps actually run
+    double residual;   // Out: last reduced residual
+};
+
+// Max or squared L2 change between two sweeps over the inclusive block [xa,xb] x [ya,yb]
+template <typename T>
+double localChange(const T* a, const T* b, int xa, int xb, int ya, int yb, int ld, bool use_l2, int numThreads = 1) {
+    double norm = 0.0;
+    if (use_l2) {
+        #pragma omp parallel for num_threads(numThreads) reduction(+:norm) if(numThreads > 1)
+        for (int x = xa; x <= xb; x++) {
+            for (int y = ya; y <= yb; y++) {
+                double d = (double)a[(size_t)x * ld + y] - b[(size_t)x * ld + y];
+                norm += d * d;
             }
         }
-        // Update u
-        #pragma omp parallel for
-        for (int x = 1; x < xsize - 1; x++) {
-            for (int y = 1; y < ysize - 1; y++) {
-                u[x * ysize + y] = 0.25 * (uu[(x-1) * ysize + y] + uu[(x+1) * ysize + y] +
-                                           uu[x * ysize + (y-1)] + uu[x * ysize + (y+1)]);
+    } else {
+        #pragma omp parallel for num_threads(numThreads) reduction(max:norm) if(numThreads > 1)
+        for (int x = xa; x <= xb; x++) {
+            for (int y = ya; y <= yb; y++) {
+                norm = std::max(norm, std::abs((double)a[(size_t)x * ld + y] - b[(size_t)x * ld + y]));
             }
         }
     }
-    return diffMat(u, serial_u, xsize, ysize);
+    return norm;
+}
+
+// Combine the local change over comm and decide whether to stop. With overlap the reduction
+// posted at the previous check is completed here and a new one is started, so the decision
+// lags one check interval but the solver never waits for a collective.
+// norm_buf[0] is the send buffer and norm_buf[1] the result of the reduction in flight.
+bool checkConvergence(Convergence* conv, double local_norm, double* norm_buf, MPI_Request* norm_request, MPI_Comm comm) {
+    MPI_Op op = conv->use_l2 ? MPI_SUM : MPI_MAX;
+    if (!conv->overlap) {
+        MPI_Allreduce(&local_norm, &norm_buf[1], 1, MPI_DOUBLE, op, comm);
+        conv->residual = conv->use_l2 ? std::sqrt(norm_buf[1]) : norm_buf[1];
+        return conv->residual < conv->tol;
+    }
+    bool converged = false;
+    if (*norm_request != MPI_REQUEST_NULL) {
+        MPI_Wait(norm_request, MPI_STATUS_IGNORE);
+        conv->residual = conv->use_l2 ? std::sqrt(norm_buf[1]) : norm_buf[1];
+        converged = conv->residual < conv->tol;
+    }
+    if (!converged) {
+        norm_buf[0] = local_norm;
+        MPI_Iallreduce(&norm_buf[0], &norm_buf[1], 1, MPI_DOUBLE, op, comm, norm_request);
+    }
+    return converged;
+}
+
+// Complete a reduction still in flight when the solver ran out of iterations
+void finishConvergence(Convergence* conv, double* norm_buf, MPI_Request* norm_request) {
+    if (*norm_request == MPI_REQUEST_NULL) return;
+    MPI_Wait(norm_request, MPI_STATUS_IGNORE);
+    conv->residual = conv->use_l2 ? std::sqrt(norm_buf[1]) : norm_buf[1];
+}
+
+// Periodic checkpoints of the MPI solvers. Checkpoints are binary grid files in global layout
+// (see GridIO.h), so a restart can use any number of ranks. They alternate between path.0 and
+// path.1, so the older one is still complete while the newer one is in flight.
+struct Checkpoint {
+    std::string path;
+    int every;            // Sweeps between checkpoints, 0 disables them
+    int start;            // Sweeps already contained in the state passed to the solver
+    int written;          // Out: checkpoints written during the solve
+    double seconds;       // Out: time this rank spent starting and finishing checkpoint writes
+    int slot;             // File the next checkpoint goes to
+    AsyncGridWrite write; // Checkpoint in flight
+};
+
+// File name of checkpoint slot 0 or 1
+std::string checkpointFile(const Checkpoint* ckpt, int slot) {
+    std::stringstream ss;
+    ss << ckpt->path << "." << slot;
+    return ss.str();
+}
+
+// Finish the previous checkpoint and start writing the current block in the background
+template <typename T>
+void takeCheckpoint(Checkpoint* ckpt, const T* block, int ld, int x0, int lx, int y0, int ly,
+                    int global_xsize, int ysize, int iterations, MPI_Comm comm) {
+    double start = MPI_Wtime();
+    finishGridWrite(ckpt->write);
+    std::string file = checkpointFile(ckpt, ckpt->slot);
+    startGridWrite(ckpt->write, file.c_str(), block, ld, x0, lx, y0, ly, global_xsize, ysize, iterations, comm);
+    ckpt->slot = 1 - ckpt->slot;
+    ckpt->written++;
+    ckpt->seconds += MPI_Wtime() - start;
+}
+
+void finishCheckpoint(Checkpoint* ckpt) {
+    double start = MPI_Wtime();
+    finishGridWrite(ckpt->write);
+    ckpt->seconds += MPI_Wtime() - start;
+}
+
+// Newest complete checkpoint slot for this grid size, -1 if there is none (collective over comm)
+int latestCheckpoint(const Checkpoint* ckpt, int global_xsize, int ysize, int* iterations, MPI_Comm comm) {
+    int best = -1;
+    *iterations = -1;
+    for (int slot = 0; slot < 2; slot++) {
+        std::string file = checkpointFile(ckpt, slot);
+        int it = gridFileIterations(file.c_str(), global_xsize, ysize, comm);
+        if (it > *iterations) {
+            *iterations = it;
+            best = slot;
+        }
+    }
+    return best;
+}
+
+// Check the strips of an MPI solve: against local_reference on every rank when it is set, otherwise
+// gathered to rank 0 and compared with serial_u there. The diff and norms are valid on rank 0.
+double verifyStrips(const double* local_u, int local_rows, int global_xsize, int ysize, int rank, double* serial_u,
+                    const double* local_reference, DiffNorms* norms, MPI_Comm comm, PhaseTimers* timers) {
+    phaseStart(timers);
+    if (local_reference) {
+        DiffNorms local_norms = reduceDiffNorms(local_u, local_reference, (size_t)local_rows * ysize, 0, comm);
+        if (norms) *norms = local_norms;
+        phaseEnd(timers, PHASE_VERIFY);
+        return local_norms.sum;
+    }
+
+    // Gather local_u to global_u for comparison
+    int size;
+    MPI_Comm_size(comm, &size);
+    std::vector<int> counts(size), displs(size);
+    MPI_Gather(&local_rows, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, comm);
+    for (int i = 1; i < size; i++) displs[i] = displs[i - 1] + counts[i - 1];
+    double* global_u = NULL;
+    if (rank == 0) global_u = new double[(size_t)global_xsize * ysize];
+    MPI_Datatype row_type = rowType(ysize);
+    MPI_Gatherv(local_u, local_rows, row_type, global_u, &counts[0], &displs[0], row_type, 0, comm);
+    MPI_Type_free(&row_type);
+    phaseEnd(timers, PHASE_GATHER);
+
+    double diff = 0.0;
+    if (rank == 0) {
+        diff = diffMat(global_u, serial_u, global_xsize, ysize);
+        if (norms) *norms = reduceDiffNorms(global_u, serial_u, (size_t)global_xsize * ysize, 0, MPI_COMM_SELF);
+        delete[] global_u;
+    }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, comm);
+    phaseEnd(timers, PHASE_VERIFY);
+    return diff;
+}
+
+// Float strips are widened and checked like double ones, against the double reference
+double verifyStrips(const float* local_u, int local_rows, int global_xsize, int ysize, int rank, double* serial_u,
+                    const double* local_reference, DiffNorms* norms, MPI_Comm comm, PhaseTimers* timers) {
+    std::vector<double> wide(local_u, local_u + (size_t)local_rows * ysize);
+    return verifyStrips(wide.data(), local_rows, global_xsize, ysize, rank, serial_u, local_reference, norms, comm, timers);
+}
+
+// Halo exchange strategies for mpiLaplace
+enum HaloMode {
+    HALO_BLOCKING,    // Two MPI_Sendrecv calls, then update every row
+    HALO_NONBLOCKING, // MPI_Isend/MPI_Irecv, update interior rows while halos are in flight
+    HALO_PERSISTENT,  // MPI_Send_init/MPI_Recv_init once per solve, MPI_Startall every iteration
+    HALO_SHARED,      // Strips in an MPI-3 shared window, on-node neighbours read halo rows in place
+    HALO_RMA,         // MPI_Put into the neighbours' ghost rows, post-start-complete-wait with the two neighbours
+    HALO_RMA_FENCE    // The same puts, synchronised with MPI_Win_fence
+};
+
+const char* haloModeName(HaloMode mode) {
+    switch (mode) {
+        case HALO_NONBLOCKING: return "nonblocking";
+        case HALO_PERSISTENT: return "persistent";
+        case HALO_SHARED: return "shared";
+        case HALO_RMA: return "rma";
+        case HALO_RMA_FENCE: return "rma-fence";
+        default: return "blocking";
+    }
+}
+
+bool parseHaloMode(const std::string& name, HaloMode& mode) {
+    if (name == "blocking") mode = HALO_BLOCKING;
+    else if (name == "nonblocking") mode = HALO_NONBLOCKING;
+    else if (name == "persistent") mode = HALO_PERSISTENT;
+    else if (name == "shared") mode = HALO_SHARED;
+    else if (name == "rma") mode = HALO_RMA;
+    else if (name == "rma-fence") mode = HALO_RMA_FENCE;
+    else return false;
+    return true;
+}
+
+// Strips of the shared-memory halo mode. Both ping-pong buffers of every rank on a node live in one
+// MPI_Win_allocate_shared window, so a neighbour on the same node can read its halo row in place;
+// upper/lower are NULL when that neighbour is on another node (or there is none).
+template <typename T>
+struct SharedStrips {
+    MPI_Comm node_comm;
+    MPI_Win win;
+    T* base;        // This rank's two buffers, local_rows * ysize each
+    const T* upper; // Upper neighbour's two buffers
+    const T* lower; // Lower neighbour's two buffers
+    int upper_rows;
+    int lower_rows;
+};
+
+// Find where a neighbour's buffers are mapped, if it shares the node. Strips without rows never
+// share, so both sides of a pair always agree on whether they exchange rows or read in place.
+template <typename T>
+static const T* sharedNeighbor(SharedStrips<T>& sh, int neighbor, int rows, int local_rows, MPI_Comm comm) {
+    if (neighbor == MPI_PROC_NULL || rows == 0 || local_rows == 0) return NULL;
+    MPI_Group world_group, node_group;
+    MPI_Comm_group(comm, &world_group);
+    MPI_Comm_group(sh.node_comm, &node_group);
+    int node_rank;
+    MPI_Group_translate_ranks(world_group, 1, &neighbor, node_group, &node_rank);
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+    if (node_rank == MPI_UNDEFINED) return NULL;
+
+    // The reported size may be rounded up to whole pages, so the caller supplies the row count
+    MPI_Aint bytes;
+    int disp_unit;
+    T* ptr;
+    MPI_Win_shared_query(sh.win, node_rank, &bytes, &disp_unit, &ptr);
+    return ptr;
+}
+
+template <typename T>
+void openSharedStrips(SharedStrips<T>& sh, int local_rows, int ysize, int upper_neighbor, int upper_rows,
+                      int lower_neighbor, int lower_rows, MPI_Comm comm) {
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &sh.node_comm);
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true"); // Let each rank's part sit in its own NUMA domain
+    MPI_Win_allocate_shared(2 * (MPI_Aint)local_rows * ysize * sizeof(T), sizeof(T), info,
+                            sh.node_comm, &sh.base, &sh.win);
+    MPI_Info_free(&info);
+    sh.upper_rows = upper_rows;
+    sh.lower_rows = lower_rows;
+    sh.upper = sharedNeighbor(sh, upper_neighbor, upper_rows, local_rows, comm);
+    sh.lower = sharedNeighbor(sh, lower_neighbor, lower_rows, local_rows, comm);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, sh.win);
+}
+
+template <typename T>
+void closeSharedStrips(SharedStrips<T>& sh) {
+    MPI_Win_unlock_all(sh.win);
+    MPI_Win_free(&sh.win);
+    MPI_Comm_free(&sh.node_comm);
+}
+
+// Ghost rows of the RMA halo modes: the upper halo at displacement 0 and the lower one at ysize,
+// exposed in one window that the neighbours MPI_Put their edge rows into
+template <typename T>
+struct RmaHalos {
+    MPI_Win win;
+    MPI_Group neighbors; // Upper and lower neighbour, the only ranks in the PSCW epochs
+    T* base;
+};
+
+template <typename T>
+void openRmaHalos(RmaHalos<T>& rma, int ysize, int upper_neighbor, int lower_neighbor, MPI_Comm comm) {
+    MPI_Win_allocate(2 * (MPI_Aint)ysize * sizeof(T), sizeof(T), MPI_INFO_NULL, comm, &rma.base, &rma.win);
+    std::fill(rma.base, rma.base + 2 * ysize, T(0));
+    int ranks[2], count = 0;
+    if (upper_neighbor != MPI_PROC_NULL) ranks[count++] = upper_neighbor;
+    if (lower_neighbor != MPI_PROC_NULL && lower_neighbor != upper_neighbor) ranks[count++] = lower_neighbor;
+    MPI_Group world_group;
+    MPI_Comm_group(comm, &world_group);
+    MPI_Group_incl(world_group, count, ranks, &rma.neighbors);
+    MPI_Group_free(&world_group);
+}
+
+template <typename T>
+void closeRmaHalos(RmaHalos<T>& rma) {
+    MPI_Group_free(&rma.neighbors);
+    MPI_Win_free(&rma.win);
 }
 
 // MPI Laplace solver
-double mpiLaplace(double* local_u, double* local_uu, int local_rows, int global_xsize, int ysize, int iter, int rank, int size, double* serial_u) {
-    int rows_per_proc = global_xsize / size;
-    int remainder = global_xsize % size;
+// With numThreads > 1 each rank updates its strip with OpenMP threads (hybrid mode); all MPI
+// calls stay on the master thread outside parallel regions, so MPI_THREAD_FUNNELED is enough.
+// With conv set and conv->tol > 0 the solve stops early once converged, see Convergence.
+// With ckpt set local_u already holds ckpt->start sweeps (restart), the solve runs up to iter
+// sweeps in total and checkpoints every ckpt->every sweeps, see Checkpoint.
+// With local_reference set (this rank's strip of the reference) the result is verified in place
+// instead of being gathered against serial_u; the norms and the returned diff are valid on rank 0.
+// In HALO_SHARED mode the sweeps run in a shared window and the result is copied back to local_u.
+// rank and size are within comm; with verify false the result is not checked at all and 0 is returned.
+// With timers set, this rank's time per phase is added to them (and traced if they have a trace).
+// Strips may have any number of rows as long as they cover the grid in rank order.
+// T is the element type of the strips and of every halo message; float strips are verified
+// against the double reference. With source set (this rank's strip of it) every updated point
+// also adds its source value, which turns the sweep into u <- avg(u) + source.
+// sides other than Dirichlet are swept too (see Problem); periodic x sides close the strips into a ring.
+template <typename T>
+double mpiLaplace(T* local_u, T* local_uu, int local_rows, int global_xsize, int ysize, int iter, int rank, int size, double* serial_u,
+                  HaloMode mode = HALO_BLOCKING, int numThreads = 1, Convergence* conv = NULL, Checkpoint* ckpt = NULL,
+                  const double* local_reference = NULL, DiffNorms* norms = NULL, MPI_Comm comm = MPI_COMM_WORLD,
+                  bool verify = true, PhaseTimers* timers = NULL, const T* source = NULL, Boundaries sides = Boundaries()) {
+    // Rows per rank and first global row of each rank
     std::vector<int> counts(size), displs(size);
+    MPI_Allgather(&local_rows, 1, MPI_INT, &counts[0], 1, MPI_INT, comm);
     int offset = 0;
     for (int i = 0; i < size; i++) {
-        int rows = rows_per_proc + (i < remainder ? 1 : 0);
-        counts[i] = rows * ysize;
         displs[i] = offset;
         offset += counts[i];
     }
 
-    double* upper_halo = new double[ysize];
-    double* lower_halo = new double[ysize];
+    // Halo neighbours are the nearest ranks with rows, so strips without rows (more ranks than
+    // rows) drop out of the chain and exchange nothing
+    bool ring = sides.x == BOUNDARY_PERIODIC;
+    int upper_neighbor = MPI_PROC_NULL;
+    int lower_neighbor = MPI_PROC_NULL;
+    for (int k = 1; local_rows > 0 && k <= size && upper_neighbor == MPI_PROC_NULL; k++) {
+        if (rank - k < 0 && !ring) break;
+        int r = (rank - k + size) % size;
+        if (counts[r] > 0) upper_neighbor = r;
+    }
+    for (int k = 1; local_rows > 0 && k <= size && lower_neighbor == MPI_PROC_NULL; k++) {
+        if (rank + k >= size && !ring) break;
+        int r = (rank + k) % size;
+        if (counts[r] > 0) lower_neighbor = r;
+    }
+
+    // Which edge rows are swept: the global first and last rows only without Dirichlet x sides,
+    // and with Neumann ones they use their mirrored inner neighbour instead of a halo
+    bool dirichlet_x = sides.x == BOUNDARY_DIRICHLET;
+    bool at_top = displs[rank] == 0;
+    bool at_bottom = displs[rank] + local_rows == global_xsize;
+    bool mirror_top = at_top && sides.x == BOUNDARY_NEUMANN;
+    bool mirror_bottom = at_bottom && sides.x == BOUNDARY_NEUMANN;
+    bool sweep_first = (local_rows > 1) ? !(at_top && dirichlet_x)
+                                        : local_rows == 1 && !((at_top || at_bottom) && dirichlet_x);
+    bool sweep_last = local_rows > 1 && !(at_bottom && dirichlet_x);
+    // A strip without rows sends nothing, from a pointer that stays inside its buffer
+    int send_count = (local_rows == 0) ? 0 : ysize;
+    size_t last_row = (size_t)std::max(local_rows - 1, 0) * ysize;
 
-    for (int i = 0; i < iter; i++) {
-        // Copy local_u to local_uu
-        for (int x = 0; x < local_rows; x++) {
-            for (int y = 0; y < ysize; y++) {
-                local_uu[x * ysize + y] = local_u[x * ysize + y];
-            }
+    // The RMA modes receive halo rows straight into window memory
+    bool rma_mode = mode == HALO_RMA || mode == HALO_RMA_FENCE;
+    RmaHalos<T> rma;
+    T* upper_halo;
+    T* lower_halo;
+    if (rma_mode) {
+        openRmaHalos(rma, ysize, upper_neighbor, lower_neighbor, comm);
+        upper_halo = rma.base;
+        lower_halo = rma.base + ysize;
+    } else {
+        upper_halo = allocAlignedAs<T>(paddedRow(ysize));
+        lower_halo = allocAlignedAs<T>(paddedRow(ysize));
+    }
+    // local_u and local_uu are swapped every sweep, so persistent requests need one set per buffer
+    T* buffers[2] = {local_u, local_uu};
+    SharedStrips<T> shared;
+    if (mode == HALO_SHARED) {
+        openSharedStrips(shared, local_rows, ysize, upper_neighbor, upper_neighbor != MPI_PROC_NULL ? counts[upper_neighbor] : 0,
+                         lower_neighbor, lower_neighbor != MPI_PROC_NULL ? counts[lower_neighbor] : 0, comm);
+        buffers[0] = shared.base;
+        buffers[1] = shared.base + (size_t)local_rows * ysize;
+    }
+    MPI_Datatype element = mpiType<T>();
+    MPI_Request requests[2][4];
+    if (mode == HALO_PERSISTENT) {
+        for (int b = 0; b < 2; b++) {
+            MPI_Recv_init(upper_halo, ysize, element, upper_neighbor, 0, comm, &requests[b][0]);
+            MPI_Recv_init(lower_halo, ysize, element, lower_neighbor, 1, comm, &requests[b][1]);
+            MPI_Send_init(buffers[b] + last_row, send_count, element, lower_neighbor, 0, comm, &requests[b][2]);
+            MPI_Send_init(buffers[b], send_count, element, upper_neighbor, 1, comm, &requests[b][3]);
         }
+    }
 
-        // Exchange halo rows
-        int upper_neighbor = (rank == 0) ? MPI_PROC_NULL : rank - 1;
-        int lower_neighbor = (rank == size - 1) ? MPI_PROC_NULL : rank + 1;
+    bool check = conv != NULL && conv->tol > 0.0;
+    double norm_buf[2];
+    MPI_Request norm_request = MPI_REQUEST_NULL;
+
+    int first = ckpt ? ckpt->start : 0;
+    bool checkpoints = ckpt != NULL && ckpt->every > 0;
+    // Sendrecv both starts and completes the exchange, so blocking and shared modes only wait
+    Phase exchange_phase = (mode == HALO_BLOCKING || mode == HALO_SHARED) ? PHASE_HALO_WAIT : PHASE_HALO_POST;
+
+    phaseStart(timers);
+    if (buffers[0] != local_u) std::copy(local_u, local_u + (size_t)local_rows * ysize, buffers[0]);
+    std::copy(local_u, local_u + (size_t)local_rows * ysize, buffers[1]);
+    phaseEnd(timers, PHASE_COPY);
+    int done = 0;
+    for (int i = 0; i < iter - first; i++) {
+        double sweep_begin = 0.0;
+        if (timers) {
+            sweep_begin = timers->mark;
+            timers->iteration = first + i + 1;
+        }
+        // cur holds the last sweep, next receives this one
+        T* cur = buffers[i % 2];
+        T* next = buffers[(i + 1) % 2];
+        MPI_Request* req = requests[i % 2];
+        const T* top = upper_halo;
+        const T* bottom = lower_halo;
 
-        MPI_Sendrecv(local_u + (local_rows - 1) * ysize, ysize, MPI_DOUBLE, lower_neighbor, 0,
-                     upper_halo, ysize, MPI_DOUBLE, upper_neighbor, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        // Exchange halo rows
+        if (mode == HALO_SHARED) {
+            // On-node neighbours send an empty message instead of a row. It tells the receiver that
+            // the sender has finished the last sweep (its cur is complete) and no longer reads the
+            // buffer the receiver is about to overwrite; off-node neighbours exchange rows as usual.
+            // A strip without rows has nothing to send.
+            int from_upper = shared.upper ? 0 : ysize;
+            int from_lower = shared.lower ? 0 : ysize;
+            int to_upper = (local_rows == 0) ? 0 : from_upper;
+            int to_lower = (local_rows == 0) ? 0 : from_lower;
+            MPI_Win_sync(shared.win);
+            MPI_Sendrecv(cur + last_row, to_lower, element, lower_neighbor, 0,
+                         upper_halo, from_upper, element, upper_neighbor, 0, comm, MPI_STATUS_IGNORE);
+            MPI_Sendrecv(cur, to_upper, element, upper_neighbor, 1,
+                         lower_halo, from_lower, element, lower_neighbor, 1, comm, MPI_STATUS_IGNORE);
+            MPI_Win_sync(shared.win);
+            if (shared.upper) top = shared.upper + (size_t)((i % 2) * shared.upper_rows + shared.upper_rows - 1) * ysize;
+            if (shared.lower) bottom = shared.lower + (i % 2) * (size_t)shared.lower_rows * ysize;
+        } else if (rma_mode) {
+            // Put the edge rows into the neighbours' ghost rows: our last row becomes the lower
+            // neighbour's upper halo, our first row the upper neighbour's lower halo
+            if (mode == HALO_RMA) {
+                MPI_Win_post(rma.neighbors, 0, rma.win);
+                MPI_Win_start(rma.neighbors, 0, rma.win);
+            } else {
+                MPI_Win_fence(MPI_MODE_NOPRECEDE, rma.win);
+            }
+            if (local_rows > 0) {
+                MPI_Put(cur + (size_t)(local_rows - 1) * ysize, ysize, element, lower_neighbor, 0, ysize, element, rma.win);
+                MPI_Put(cur, ysize, element, upper_neighbor, ysize, ysize, element, rma.win);
+            }
+        } else if (mode == HALO_NONBLOCKING) {
+            MPI_Irecv(upper_halo, ysize, element, upper_neighbor, 0, comm, &req[0]);
+            MPI_Irecv(lower_halo, ysize, element, lower_neighbor, 1, comm, &req[1]);
+            MPI_Isend(cur + last_row, send_count, element, lower_neighbor, 0, comm, &req[2]);
+            MPI_Isend(cur, send_count, element, upper_neighbor, 1, comm, &req[3]);
+        } else if (mode == HALO_PERSISTENT) {
+            MPI_Startall(4, req);
+        } else {
+            MPI_Sendrecv(cur + last_row, send_count, element, lower_neighbor, 0,
+                         upper_halo, ysize, element, upper_neighbor, 0, comm, MPI_STATUS_IGNORE);
 
-        MPI_Sendrecv(local_u, ysize, MPI_DOUBLE, upper_neighbor, 1,
-                     lower_halo, ysize, MPI_DOUBLE, lower_neighbor, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Sendrecv(cur, send_count, element, upper_neighbor, 1,
+                         lower_halo, ysize, element, lower_neighbor, 1, comm, MPI_STATUS_IGNORE);
+        }
+        phaseEnd(timers, exchange_phase);
 
-        // Update local_u
+        // Update interior rows, which only need local data
+        #pragma omp parallel for num_threads(numThreads) proc_bind(close) if(numThreads > 1)
         for (int x = 1; x < local_rows - 1; x++) {
-            for (int y = 1; y < ysize - 1; y++) {
-                local_u[x * ysize + y] = 0.25 * (local_uu[(x-1) * ysize + y] + local_uu[(x+1) * ysize + y] +
-                                                 local_uu[x * ysize + (y-1)] + local_uu[x * ysize + (y+1)]);
+            updateRow(next + (size_t)x * ysize, cur + (size_t)(x-1) * ysize, cur + (size_t)x * ysize, cur + (size_t)(x+1) * ysize, ysize,
+                      source ? source + (size_t)x * ysize : NULL, sides.y);
+        }
+        phaseEnd(timers, PHASE_INTERIOR);
+
+        if (mode == HALO_NONBLOCKING || mode == HALO_PERSISTENT) {
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+        } else if (mode == HALO_RMA) {
+            MPI_Win_complete(rma.win);
+            MPI_Win_wait(rma.win);
+        } else if (mode == HALO_RMA_FENCE) {
+            MPI_Win_fence(MPI_MODE_NOSUCCEED, rma.win);
+        }
+        phaseEnd(timers, PHASE_HALO_WAIT);
+
+        // Update the edge rows next to the halos
+        if (sweep_first) { // Upper boundary row
+            const T* down = (local_rows > 1) ? cur + ysize : bottom;
+            const T* up = mirror_top ? down : top;
+            if (mirror_bottom && local_rows == 1) down = up;
+            updateRow(next, up, cur, down, ysize, source, sides.y);
+        }
+        if (sweep_last) { // Lower boundary row
+            const T* up = cur + (size_t)(local_rows-2) * ysize;
+            updateRow(next + (size_t)(local_rows-1) * ysize, up, cur + (size_t)(local_rows-1) * ysize,
+                      mirror_bottom ? up : bottom, ysize, source ? source + (size_t)(local_rows-1) * ysize : NULL, sides.y);
+        }
+        phaseEnd(timers, PHASE_EDGE);
+
+        done = i + 1;
+        if (checkpoints && (first + done) % ckpt->every == 0) {
+            takeCheckpoint(ckpt, next, ysize, displs[rank], local_rows, 0, ysize,
+                           global_xsize, ysize, first + done, comm);
+        }
+        bool converged = false;
+        if (check && done % conv->check_every == 0) {
+            double local_norm = localChange(next, cur, 0, local_rows - 1, 0, ysize - 1, ysize, conv->use_l2, numThreads);
+            converged = checkConvergence(conv, local_norm, norm_buf, &norm_request, comm);
+        }
+        phaseEnd(timers, PHASE_CHECK);
+        if (timers) traceEvent(timers->trace, "iteration", sweep_begin, timers->mark, first + done);
+        if (converged) break;
+    }
+    if (checkpoints) finishCheckpoint(ckpt);
+    if (check) {
+        finishConvergence(conv, norm_buf, &norm_request);
+        conv->iterations = first + done;
+    }
+    phaseEnd(timers, PHASE_CHECK);
+    if (buffers[done % 2] != local_u) std::copy(buffers[done % 2], buffers[done % 2] + (size_t)local_rows * ysize, local_u);
+    phaseEnd(timers, PHASE_COPY);
+
+    if (mode == HALO_PERSISTENT) {
+        for (int b = 0; b < 2; b++) {
+            for (int r = 0; r < 4; r++) MPI_Request_free(&requests[b][r]);
+        }
+    }
+    if (mode == HALO_SHARED) closeSharedStrips(shared);
+
+    if (rma_mode) {
+        closeRmaHalos(rma);
+    } else {
+        freeAligned(upper_halo);
+        freeAligned(lower_halo);
+    }
+
+    if (!verify) return 0.0;
+    return verifyStrips(local_u, local_rows, global_xsize, ysize, rank, serial_u, local_reference, norms, comm, timers);
+}
+
+// mpiLaplace with load balancing, see BalanceOptions. local_u is this rank's strip of the even split
+// and receives the result in the same layout; in between the strips are resized by migrating rows.
+// The solve runs in segments of balance->every sweeps, so it is bit-identical to an unbalanced one.
+double balancedLaplace(double* local_u, int local_rows, int global_xsize, int ysize, int iter, int rank, int size,
+                       double* serial_u, HaloMode mode, int numThreads, Convergence* conv, BalanceOptions* balance,
+                       const double* local_reference = NULL, DiffNorms* norms = NULL, PhaseTimers* timers = NULL,
+                       MPI_Comm comm = MPI_COMM_WORLD) {
+    std::vector<int> even_rows(size), rows(size);
+    MPI_Allgather(&local_rows, 1, MPI_INT, &even_rows[0], 1, MPI_INT, comm);
+    rows = even_rows;
+
+    PhaseTimers segment;
+    resetPhaseTimers(segment);
+    segment.trace = timers ? timers->trace : NULL;
+    phaseStart(&segment);
+    int strip_rows = local_rows;
+    double* strip = allocAligned((size_t)std::max(strip_rows, 1) * ysize);
+    std::copy(local_u, local_u + (size_t)strip_rows * ysize, strip);
+    balance->migrations = 0;
+    if (conv != NULL) conv->residual = HUGE_VAL;
+    if (!balance->weights.empty()) {
+        rows = partitionRows(global_xsize, balance->weights, 1);
+        migrateRows(strip, strip_rows, even_rows, rows, ysize, comm);
+    }
+    double* scratch = allocAligned((size_t)std::max(strip_rows, 1) * ysize);
+    phaseEnd(&segment, PHASE_MIGRATE);
+
+    // Segments restart the solver from the sweeps done so far, which is exactly a restart
+    Checkpoint resume = {"", 0, 0, 0, 0.0, 0, AsyncGridWrite()};
+    int done = 0;
+    while (done < iter) {
+        int sweeps = (balance->every > 0) ? std::min(balance->every, iter - done) : iter - done;
+        resume.start = done;
+        double busy = segment.seconds[PHASE_INTERIOR] + segment.seconds[PHASE_EDGE];
+        mpiLaplace(strip, scratch, strip_rows, global_xsize, ysize, done + sweeps, rank, size, NULL, mode,
+                   numThreads, conv, &resume, NULL, NULL, comm, false, &segment);
+        busy = segment.seconds[PHASE_INTERIOR] + segment.seconds[PHASE_EDGE] - busy;
+        done += sweeps;
+        if (conv != NULL && conv->tol > 0.0 && (conv->iterations < done || conv->residual < conv->tol)) {
+            done = conv->iterations;
+            break;
+        }
+        if (done == iter || balance->every <= 0) continue;
+
+        // Rows per second of every rank, and how long each took against a split in proportion to them
+        phaseStart(&segment);
+        double rate = (busy > 0.0) ? (double)strip_rows * sweeps / busy : 0.0;
+        std::vector<double> rates(size);
+        MPI_Allgather(&rate, 1, MPI_DOUBLE, &rates[0], 1, MPI_DOUBLE, comm);
+        double total_rate = 0.0, slowest = 0.0;
+        bool measured = true;
+        for (int r = 0; r < size; r++) {
+            if (rates[r] <= 0.0) measured = false;
+            total_rate += rates[r];
+            if (rates[r] > 0.0) slowest = std::max(slowest, rows[r] * sweeps / rates[r]);
+        }
+        double balanced = measured ? (double)global_xsize * sweeps / total_rate : 0.0;
+        if (measured && slowest > (1.0 + balance->threshold) * balanced) {
+            std::vector<int> new_rows = partitionRows(global_xsize, rates, 1);
+            if (new_rows != rows) {
+                migrateRows(strip, strip_rows, rows, new_rows, ysize, comm);
+                freeAligned(scratch);
+                scratch = allocAligned((size_t)std::max(strip_rows, 1) * ysize);
+                rows = new_rows;
+                balance->migrations++;
+            }
+        }
+        phaseEnd(&segment, PHASE_MIGRATE);
+    }
+    if (conv != NULL && conv->tol > 0.0) conv->iterations = done;
+    balance->rows = rows;
+
+    // Back to the caller's layout
+    phaseStart(&segment);
+    migrateRows(strip, strip_rows, rows, even_rows, ysize, comm);
+    std::copy(strip, strip + (size_t)local_rows * ysize, local_u);
+    freeAligned(strip);
+    freeAligned(scratch);
+    phaseEnd(&segment, PHASE_MIGRATE);
+    if (timers) {
+        for (int p = 0; p < PHASE_COUNT; p++) timers->seconds[p] += segment.seconds[p];
+    }
+    return verifyStrips(local_u, local_rows, global_xsize, ysize, rank, serial_u, local_reference, norms, comm, timers);
+}
+
+// How the MPI strip results are checked against the serial reference
+enum VerifyMode {
+    VERIFY_GATHER,  // Gather the whole grid on rank 0 and call diffMat
+    VERIFY_SCATTER, // Scatter the serial reference, every rank checks its strip
+    VERIFY_FILE     // Every rank reads its strip of a reference file, no rank holds the whole grid
+};
+
+const char* verifyModeName(VerifyMode mode) {
+    switch (mode) {
+        case VERIFY_SCATTER: return "scatter";
+        case VERIFY_FILE: return "file";
+        default: return "gather";
+    }
+}
+
+bool parseVerifyMode(const std::string& name, VerifyMode& mode) {
+    if (name == "gather") mode = VERIFY_GATHER;
+    else if (name == "scatter") mode = VERIFY_SCATTER;
+    else if (name == "file") mode = VERIFY_FILE;
+    else return false;
+    return true;
+}
+
+// Domain decompositions for the MPI solver
+enum Decomposition {
+    DECOMP_STRIPS, // Horizontal strips of full rows (mpiLaplace)
+    DECOMP_CART    // 2D blocks on an MPI_Cart_create process grid (mpiLaplace2D)
+};
+
+const char* decompositionName(Decomposition decomp) {
+    return decomp == DECOMP_CART ? "cart" : "strips";
+}
+
+bool parseDecomposition(const std::string& name, Decomposition& decomp) {
+    if (name == "strips") decomp = DECOMP_STRIPS;
+    else if (name == "cart") decomp = DECOMP_CART;
+    else return false;
+    return true;
+}
+
+const char* precisionName(Precision precision) {
+    switch (precision) {
+        case PRECISION_FLOAT: return "float";
+        case PRECISION_MIXED: return "mixed";
+        default: return "double";
+    }
+}
+
+bool parsePrecision(const std::string& name, Precision& precision) {
+    if (name == "double") precision = PRECISION_DOUBLE;
+    else if (name == "float") precision = PRECISION_FLOAT;
+    else if (name == "mixed") precision = PRECISION_MIXED;
+    else return false;
+    return true;
+}
+
+// Split n points into parts nearly even blocks, same rule as the strip split
+void blockRange(int n, int parts, int idx, int& start, int& len) {
+    int per_part = n / parts;
+    int remainder = n % parts;
+    len = per_part + (idx < remainder ? 1 : 0);
+    start = idx * per_part + std::min(idx, remainder);
+}
+
+// Pick a 2D process grid for an xsize x ysize grid; returns how many ranks it uses,
+// ranks beyond dims[0]*dims[1] get MPI_COMM_NULL from MPI_Cart_create and stay idle
+int cartDims(int size, int xsize, int ysize, int dims[2]) {
+    for (int active = size; active > 1; active--) {
+        dims[0] = dims[1] = 0;
+        MPI_Dims_create(active, 2, dims);
+        if (dims[0] <= xsize && dims[1] <= ysize) return active;
+    }
+    dims[0] = dims[1] = 1;
+    return 1;
+}
+
+// Jacobi update of the inclusive block [xa,xb] x [ya,yb] of a ghosted array with row length ld,
+// plus the source when there is one (laid out like the array)
+inline void updateBlock(double* u, const double* uu, int xa, int xb, int ya, int yb, int ld, int numThreads = 1,
+                        const double* source = NULL) {
+    #pragma omp parallel for num_threads(numThreads) proc_bind(close) if(numThreads > 1)
+    for (int x = xa; x <= xb; x++) {
+        stencilRow(u + (size_t)x * ld, uu + (size_t)(x-1) * ld, uu + (size_t)x * ld, uu + (size_t)(x+1) * ld,
+                   source ? source + (size_t)x * ld : NULL, ya, yb + 1);
+    }
+}
+
+// MPI Laplace solver on a 2D block decomposition. global_u and serial_u are only used on
+// rank 0, where global_u holds the result on return; blocks are scattered and gathered with
+// MPI_Type_vector types. With output set every block is also written to that binary file
+// (see writeGridMPIIO) and the seconds spent writing go to *write_time. Checkpoints and
+// restarts work as in mpiLaplace, with global_u holding the restart state.
+// rank and size are within comm; with reorder MPI may renumber the process grid to fit the machine,
+// and rank 0 of comm (which holds global_u) scatters and gathers whatever its grid rank.
+// source (the whole grid, on rank 0) and sides work as in mpiLaplace: periodic sides become periodic
+// dimensions of the process grid, so their halos wrap around, and Neumann sides fill the ghost frame
+// on the global boundary with the mirrored inner row or column. The shared and RMA modes need
+// strips, so they exchange like HALO_BLOCKING here.
+double mpiLaplace2D(double* global_u, int global_xsize, int ysize, int iter, int rank, int size, double* serial_u,
+                    HaloMode mode = HALO_BLOCKING, int numThreads = 1, Convergence* conv = NULL,
+                    const char* output = NULL, double* write_time = NULL, Checkpoint* ckpt = NULL,
+                    MPI_Comm comm = MPI_COMM_WORLD, bool reorder = false, const double* source = NULL,
+                    Boundaries sides = Boundaries()) {
+    int dims[2];
+    int periods[2] = {sides.x == BOUNDARY_PERIODIC, sides.y == BOUNDARY_PERIODIC};
+    int active = cartDims(size, global_xsize, ysize, dims);
+    // The grid is built from the first active ranks, so rank 0 of comm is always in it
+    MPI_Comm members, cart = MPI_COMM_NULL;
+    MPI_Comm_split(comm, rank < active ? 0 : MPI_UNDEFINED, rank, &members);
+    if (members != MPI_COMM_NULL) {
+        MPI_Cart_create(members, 2, dims, periods, reorder ? 1 : 0, &cart);
+        MPI_Comm_free(&members);
+    }
+
+    double diff = 0.0;
+    if (cart != MPI_COMM_NULL) {
+        int cart_rank, cart_size, coords[2];
+        MPI_Comm_rank(cart, &cart_rank);
+        MPI_Comm_size(cart, &cart_size);
+        MPI_Cart_coords(cart, cart_rank, 2, coords);
+        // Grid rank of rank 0 of comm
+        int root, mine = (rank == 0) ? cart_rank : -1;
+        MPI_Allreduce(&mine, &root, 1, MPI_INT, MPI_MAX, cart);
+
+        int x0, lx, y0, ly;
+        blockRange(global_xsize, dims[0], coords[0], x0, lx);
+        blockRange(ysize, dims[1], coords[1], y0, ly);
+        // Local row length: the two ghost columns plus padding to whole 64-byte vectors
+        int ld = paddedRow(ly + 2);
+
+        double* u = allocAligned((size_t)(lx + 2) * ld);
+        double* uu = allocAligned((size_t)(lx + 2) * ld);
+        std::fill(u, u + (size_t)(lx + 2) * ld, 0.0);
+        std::fill(uu, uu + (size_t)(lx + 2) * ld, 0.0);
+        int has_source = (cart_rank == root && source) ? 1 : 0;
+        MPI_Bcast(&has_source, 1, MPI_INT, root, cart);
+        double* src = NULL;
+        if (has_source) {
+            src = allocAligned((size_t)(lx + 2) * ld);
+            std::fill(src, src + (size_t)(lx + 2) * ld, 0.0);
+        }
+
+        MPI_Datatype column_type, block_type;
+        MPI_Type_vector(lx, 1, ld, MPI_DOUBLE, &column_type);
+        MPI_Type_vector(lx, ly, ld, MPI_DOUBLE, &block_type);
+        MPI_Type_commit(&column_type);
+        MPI_Type_commit(&block_type);
+
+        // Scatter: the root sends each block straight out of global_u, and out of source if there is one
+        const double* globals[2] = {global_u, source};
+        double* blocks[2] = {u, src};
+        for (int g = 0; g < 1 + has_source; g++) {
+            std::vector<MPI_Request> block_requests;
+            if (cart_rank == root) {
+                block_requests.resize(cart_size);
+                for (int r = 0; r < cart_size; r++) {
+                    int c[2], bx0, blx, by0, bly;
+                    MPI_Cart_coords(cart, r, 2, c);
+                    blockRange(global_xsize, dims[0], c[0], bx0, blx);
+                    blockRange(ysize, dims[1], c[1], by0, bly);
+                    MPI_Datatype global_block;
+                    MPI_Type_vector(blx, bly, ysize, MPI_DOUBLE, &global_block);
+                    MPI_Type_commit(&global_block);
+                    MPI_Isend(globals[g] + (size_t)bx0 * ysize + by0, 1, global_block, r, 0, cart, &block_requests[r]);
+                    MPI_Type_free(&global_block);
+                }
+            }
+            MPI_Recv(blocks[g] + ld + 1, 1, block_type, root, 0, cart, MPI_STATUS_IGNORE);
+            if (cart_rank == root) MPI_Waitall(cart_size, &block_requests[0], MPI_STATUSES_IGNORE);
+        }
+
+        int up, down, left, right;
+        MPI_Cart_shift(cart, 0, 1, &up, &down);
+        MPI_Cart_shift(cart, 1, 1, &left, &right);
+
+        // Local range of points to update, skipping Dirichlet sides of the global boundary
+        bool fixed_x = sides.x == BOUNDARY_DIRICHLET, fixed_y = sides.y == BOUNDARY_DIRICHLET;
+        int xa = (x0 == 0 && fixed_x) ? 2 : 1;
+        int xb = (x0 + lx == global_xsize && fixed_x) ? lx - 1 : lx;
+        int ya = (y0 == 0 && fixed_y) ? 2 : 1;
+        int yb = (y0 + ly == ysize && fixed_y) ? ly - 1 : ly;
+        int ra = std::max(xa, 2), rb = std::min(xb, lx - 1);
+        bool mirror_top = x0 == 0 && sides.x == BOUNDARY_NEUMANN;
+        bool mirror_bottom = x0 + lx == global_xsize && sides.x == BOUNDARY_NEUMANN;
+        bool mirror_left = y0 == 0 && sides.y == BOUNDARY_NEUMANN;
+        bool mirror_right = y0 + ly == ysize && sides.y == BOUNDARY_NEUMANN;
+
+        // Halos are sent from and received into the ghost frame of the buffer holding
+        // the last sweep; u and uu alternate, so persistent requests need one set per buffer
+        double* buffers[2] = {u, uu};
+        MPI_Request requests[2][8];
+        if (mode == HALO_PERSISTENT) {
+            for (int b = 0; b < 2; b++) {
+                double* cur = buffers[b];
+                MPI_Recv_init(cur + 1, ly, MPI_DOUBLE, up, 0, cart, &requests[b][0]);
+                MPI_Recv_init(cur + (size_t)(lx + 1) * ld + 1, ly, MPI_DOUBLE, down, 1, cart, &requests[b][1]);
+                MPI_Recv_init(cur + ld, 1, column_type, left, 2, cart, &requests[b][2]);
+                MPI_Recv_init(cur + ld + ly + 1, 1, column_type, right, 3, cart, &requests[b][3]);
+                MPI_Send_init(cur + (size_t)lx * ld + 1, ly, MPI_DOUBLE, down, 0, cart, &requests[b][4]);
+                MPI_Send_init(cur + ld + 1, ly, MPI_DOUBLE, up, 1, cart, &requests[b][5]);
+                MPI_Send_init(cur + ld + ly, 1, column_type, right, 2, cart, &requests[b][6]);
+                MPI_Send_init(cur + ld + 1, 1, column_type, left, 3, cart, &requests[b][7]);
+            }
+        }
+
+        bool check = conv != NULL && conv->tol > 0.0;
+        double norm_buf[2];
+        MPI_Request norm_request = MPI_REQUEST_NULL;
+
+        int first = ckpt ? ckpt->start : 0;
+        bool checkpoints = ckpt != NULL && ckpt->every > 0;
+
+        std::copy(u, u + (size_t)(lx + 2) * ld, uu);
+        int done = 0;
+        for (int i = 0; i < iter - first; i++) {
+            double* cur = buffers[i % 2];
+            double* next = buffers[(i + 1) % 2];
+            MPI_Request* req = requests[i % 2];
+
+            // Exchange row and column halos
+            if (mode == HALO_NONBLOCKING) {
+                MPI_Irecv(cur + 1, ly, MPI_DOUBLE, up, 0, cart, &req[0]);
+                MPI_Irecv(cur + (size_t)(lx + 1) * ld + 1, ly, MPI_DOUBLE, down, 1, cart, &req[1]);
+                MPI_Irecv(cur + ld, 1, column_type, left, 2, cart, &req[2]);
+                MPI_Irecv(cur + ld + ly + 1, 1, column_type, right, 3, cart, &req[3]);
+                MPI_Isend(cur + (size_t)lx * ld + 1, ly, MPI_DOUBLE, down, 0, cart, &req[4]);
+                MPI_Isend(cur + ld + 1, ly, MPI_DOUBLE, up, 1, cart, &req[5]);
+                MPI_Isend(cur + ld + ly, 1, column_type, right, 2, cart, &req[6]);
+                MPI_Isend(cur + ld + 1, 1, column_type, left, 3, cart, &req[7]);
+            } else if (mode == HALO_PERSISTENT) {
+                MPI_Startall(8, req);
+            } else {
+                MPI_Sendrecv(cur + (size_t)lx * ld + 1, ly, MPI_DOUBLE, down, 0,
+                             cur + 1, ly, MPI_DOUBLE, up, 0, cart, MPI_STATUS_IGNORE);
+                MPI_Sendrecv(cur + ld + 1, ly, MPI_DOUBLE, up, 1,
+                             cur + (size_t)(lx + 1) * ld + 1, ly, MPI_DOUBLE, down, 1, cart, MPI_STATUS_IGNORE);
+                MPI_Sendrecv(cur + ld + ly, 1, column_type, right, 2,
+                             cur + ld, 1, column_type, left, 2, cart, MPI_STATUS_IGNORE);
+                MPI_Sendrecv(cur + ld + 1, 1, column_type, left, 3,
+                             cur + ld + ly + 1, 1, column_type, right, 3, cart, MPI_STATUS_IGNORE);
             }
+
+            // Update points that don't touch the ghost frame
+            updateBlock(next, cur, ra, rb, std::max(ya, 2), std::min(yb, ly - 1), ld, numThreads, src);
+
+            if (mode == HALO_NONBLOCKING || mode == HALO_PERSISTENT) {
+                MPI_Waitall(8, req, MPI_STATUSES_IGNORE);
+            }
+
+            // Neumann sides: the ghost frame gets row/column 2, which is the far halo of a one-wide block
+            if (mirror_top) std::copy(cur + 2 * ld + 1, cur + 2 * ld + 1 + ly, cur + 1);
+            if (mirror_bottom) std::copy(cur + (size_t)(lx - 1) * ld + 1, cur + (size_t)(lx - 1) * ld + 1 + ly, cur + (size_t)(lx + 1) * ld + 1);
+            for (int x = 1; (mirror_left || mirror_right) && x <= lx; x++) {
+                if (mirror_left) cur[(size_t)x * ld] = cur[(size_t)x * ld + 2];
+                if (mirror_right) cur[(size_t)x * ld + ly + 1] = cur[(size_t)x * ld + ly - 1];
+            }
+
+            // Update the outer frame of the block: first/last rows, then first/last columns
+            if (xa == 1) updateBlock(next, cur, 1, std::min(xb, 1), ya, yb, ld, 1, src);
+            if (lx > 1 && xb == lx) updateBlock(next, cur, lx, lx, ya, yb, ld, 1, src);
+            if (ya == 1) updateBlock(next, cur, ra, rb, 1, std::min(yb, 1), ld, 1, src);
+            if (ly > 1 && yb == ly) updateBlock(next, cur, ra, rb, ly, ly, ld, 1, src);
+
+            done = i + 1;
+            if (checkpoints && (first + done) % ckpt->every == 0) {
+                takeCheckpoint(ckpt, next + ld + 1, ld, x0, lx, y0, ly, global_xsize, ysize, first + done, cart);
+            }
+            if (check && done % conv->check_every == 0) {
+                double local_norm = localChange(next, cur, 1, lx, 1, ly, ld, conv->use_l2, numThreads);
+                if (checkConvergence(conv, local_norm, norm_buf, &norm_request, cart)) break;
+            }
+        }
+        if (checkpoints) finishCheckpoint(ckpt);
+        if (check) {
+            finishConvergence(conv, norm_buf, &norm_request);
+            conv->iterations = first + done;
         }
+        if (done % 2 == 1) std::copy(uu, uu + (size_t)(lx + 2) * ld, u);
 
-        if (rank > 0 && local_rows > 0) { // Upper boundary row
-            for (int y = 1; y < ysize - 1; y++) {
-                local_u[0 * ysize + y] = 0.25 * (upper_halo[y] + local_uu[1 * ysize + y] +
-                                                 local_uu[0 * ysize + (y-1)] + local_uu[0 * ysize + (y+1)]);
+        if (mode == HALO_PERSISTENT) {
+            for (int b = 0; b < 2; b++) {
+                for (int r = 0; r < 8; r++) MPI_Request_free(&requests[b][r]);
             }
         }
-        if (rank < size - 1 && local_rows > 0) { // Lower boundary row
-            for (int y = 1; y < ysize - 1; y++) {
-                local_u[(local_rows-1) * ysize + y] = 0.25 * (local_uu[(local_rows-2) * ysize + y] + lower_halo[y] +
-                                                              local_uu[(local_rows-1) * ysize + (y-1)] + local_uu[(local_rows-1) * ysize + (y+1)]);
+
+        if (output) {
+            double t = writeGridMPIIO(output, u + ld + 1, ld, x0, lx, y0, ly, global_xsize, ysize, first + done, cart);
+            if (write_time) *write_time = t;
+        }
+
+        // Gather blocks into a global grid on the root for comparison
+        MPI_Request send_request;
+        MPI_Isend(u + ld + 1, 1, block_type, root, 1, cart, &send_request);
+        if (cart_rank == root) {
+            double* result = new double[(size_t)global_xsize * ysize];
+            for (int r = 0; r < cart_size; r++) {
+                int c[2], bx0, blx, by0, bly;
+                MPI_Cart_coords(cart, r, 2, c);
+                blockRange(global_xsize, dims[0], c[0], bx0, blx);
+                blockRange(ysize, dims[1], c[1], by0, bly);
+                MPI_Datatype global_block;
+                MPI_Type_vector(blx, bly, ysize, MPI_DOUBLE, &global_block);
+                MPI_Type_commit(&global_block);
+                MPI_Recv(result + (size_t)bx0 * ysize + by0, 1, global_block, r, 1, cart, MPI_STATUS_IGNORE);
+                MPI_Type_free(&global_block);
             }
+            diff = diffMat(result, serial_u, global_xsize, ysize);
+            std::copy(result, result + (size_t)global_xsize * ysize, global_u);
+            delete[] result;
         }
+        MPI_Wait(&send_request, MPI_STATUS_IGNORE);
+
+        MPI_Type_free(&column_type);
+        MPI_Type_free(&block_type);
+        MPI_Comm_free(&cart);
+        freeAligned(u);
+        freeAligned(uu);
+        freeAligned(src);
     }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, comm);
+    return diff;
+}
 
-    // Gather local_u to global_u for comparison
-    double* global_u = NULL;
-    if (rank == 0) global_u = new double[global_xsize * ysize];
-    MPI_Gatherv(local_u, local_rows * ysize, MPI_DOUBLE,
-                global_u, &counts[0], &displs[0], MPI_DOUBLE, 0, MPI_COMM_WORLD);
+// Largest defect of one Jacobi sweep in a row, max |avg(u) - u|
+inline double defectMax(const double* up, const double* mid, const double* down, int ysize) {
+    double dmax = 0.0;
+    for (int y = 1; y < ysize - 1; y++) {
+        dmax = std::max(dmax, std::abs(0.25 * (up[y] + down[y] + mid[y-1] + mid[y+1]) - mid[y]));
+    }
+    return dmax;
+}
 
-    double diff = 0.0;
-    if (rank == 0) {
-        diff = diffMat(global_u, serial_u, global_xsize, ysize);
-        delete[] global_u;
+// The defect of a row times scale, formed in double and stored in float
+inline void defectRow(float* d, const double* up, const double* mid, const double* down, int ysize, double scale) {
+    for (int y = 1; y < ysize - 1; y++) {
+        d[y] = (float)(scale * (0.25 * (up[y] + down[y] + mid[y-1] + mid[y+1]) - mid[y]));
     }
-    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+}
 
-    delete[] upper_halo;
-    delete[] lower_halo;
-    return diff;
+// Mixed precision OpenMP solver (iterative refinement). Jacobi is affine, so m sweeps from u give
+// u + e, where e starts at 0 and is swept as e <- avg(e) + d with the defect d = avg(u) - u.
+// Every refine_every sweeps d is formed from u in double, e is swept in float and added to u,
+// so the sweeps move half the bytes while u accumulates in double. d is scaled to a largest value
+// of 1 (e scales with it), so a converging defect never sinks into float denormals.
+double openMPMixedLaplace(double* u, int xsize, int ysize, int iter, int numThreads, int refine_every, double* serial_u) {
+    size_t n = (size_t)xsize * ysize;
+    float* d = allocAlignedAs<float>(n);
+    float* e = allocAlignedAs<float>(n);
+    float* ee = allocAlignedAs<float>(n);
+    for (int done = 0; done < iter; done += refine_every) {
+        int sweeps = std::min(refine_every, iter - done);
+        double dmax = 0.0;
+        #pragma omp parallel for num_threads(numThreads) schedule(static) reduction(max:dmax)
+        for (int x = 1; x < xsize - 1; x++) {
+            size_t row = (size_t)x * ysize;
+            dmax = std::max(dmax, defectMax(u + row - ysize, u + row, u + row + ysize, ysize));
+        }
+        if (dmax == 0.0) break; // Already a fixed point
+        #pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int x = 0; x < xsize; x++) {
+            size_t row = (size_t)x * ysize;
+            std::fill(d + row, d + row + ysize, 0.0f);
+            std::fill(e + row, e + row + ysize, 0.0f);
+            std::fill(ee + row, ee + row + ysize, 0.0f);
+            if (x > 0 && x < xsize - 1) defectRow(d + row, u + row - ysize, u + row, u + row + ysize, ysize, 1.0 / dmax);
+        }
+        float* cur = e;
+        float* next = ee;
+        for (int i = 0; i < sweeps; i++) {
+            #pragma omp parallel for num_threads(numThreads) schedule(static)
+            for (int x = 1; x < xsize - 1; x++) {
+                updateRow(next + (size_t)x * ysize, cur + (size_t)(x-1) * ysize, cur + (size_t)x * ysize,
+                          cur + (size_t)(x+1) * ysize, ysize, d + (size_t)x * ysize);
+            }
+            std::swap(cur, next);
+        }
+        #pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int x = 1; x < xsize - 1; x++) {
+            for (int y = 1; y < ysize - 1; y++) u[(size_t)x * ysize + y] += dmax * cur[(size_t)x * ysize + y];
+        }
+    }
+    freeAligned(d);
+    freeAligned(e);
+    freeAligned(ee);
+    return diffMat(u, serial_u, xsize, ysize);
+}
+
+// Mixed precision strips solver: the correction of openMPMixedLaplace is swept by mpiLaplace<float>
+// with the defect as its source, so every halo message is a float row. Forming the defect takes one
+// exchange of double edge rows and a reduction of the defect scale per refinement. With conv set the
+// solve stops as in mpiLaplace, the residual being the change of the correction; there are no checkpoints.
+double mpiMixedLaplace(double* local_u, int local_rows, int global_xsize, int ysize, int iter, int rank, int size,
+                       double* serial_u, HaloMode mode, int numThreads, int refine_every, Convergence* conv,
+                       const double* local_reference = NULL, DiffNorms* norms = NULL, MPI_Comm comm = MPI_COMM_WORLD,
+                       PhaseTimers* timers = NULL) {
+    int row0 = 0;
+    MPI_Exscan(&local_rows, &row0, 1, MPI_INT, MPI_SUM, comm);
+    if (rank == 0) row0 = 0;
+    int upper_neighbor = (rank == 0) ? MPI_PROC_NULL : rank - 1;
+    int lower_neighbor = (rank == size - 1) ? MPI_PROC_NULL : rank + 1;
+    // A strip without rows sends nothing, from a pointer that stays inside its strip
+    int send_count = (local_rows == 0) ? 0 : ysize;
+    size_t last_row = (size_t)std::max(local_rows - 1, 0) * ysize;
+
+    size_t n = (size_t)std::max(local_rows, 1) * ysize;
+    std::vector<double> upper_halo(ysize, 0.0), lower_halo(ysize, 0.0);
+    float* d = allocAlignedAs<float>(n);
+    float* e = allocAlignedAs<float>(n);
+    float* ee = allocAlignedAs<float>(n);
+    bool check = conv != NULL && conv->tol > 0.0;
+    if (check) conv->residual = HUGE_VAL;
+
+    int done = 0;
+    while (done < iter) {
+        int sweeps = std::min(refine_every, iter - done);
+        phaseStart(timers);
+        MPI_Sendrecv(local_u + last_row, send_count, MPI_DOUBLE, lower_neighbor, 0,
+                     upper_halo.data(), ysize, MPI_DOUBLE, upper_neighbor, 0, comm, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(local_u, send_count, MPI_DOUBLE, upper_neighbor, 1,
+                     lower_halo.data(), ysize, MPI_DOUBLE, lower_neighbor, 1, comm, MPI_STATUS_IGNORE);
+        phaseEnd(timers, PHASE_HALO_WAIT);
+
+        // The global boundary rows have no defect, so their correction stays 0
+        int xa = (row0 == 0) ? 1 : 0;
+        int xb = (row0 + local_rows == global_xsize) ? local_rows - 2 : local_rows - 1;
+        double local_max = 0.0, dmax;
+        #pragma omp parallel for num_threads(numThreads) proc_bind(close) reduction(max:local_max) if(numThreads > 1)
+        for (int x = xa; x <= xb; x++) {
+            const double* up = (x > 0) ? local_u + (size_t)(x - 1) * ysize : upper_halo.data();
+            const double* down = (x < local_rows - 1) ? local_u + (size_t)(x + 1) * ysize : lower_halo.data();
+            local_max = std::max(local_max, defectMax(up, local_u + (size_t)x * ysize, down, ysize));
+        }
+        phaseEnd(timers, PHASE_INTERIOR);
+        MPI_Allreduce(&local_max, &dmax, 1, MPI_DOUBLE, MPI_MAX, comm);
+        phaseEnd(timers, PHASE_CHECK);
+        if (dmax == 0.0) { // Already a fixed point
+            if (check) conv->residual = 0.0;
+            break;
+        }
+        #pragma omp parallel for num_threads(numThreads) proc_bind(close) if(numThreads > 1)
+        for (int x = 0; x < local_rows; x++) {
+            size_t row = (size_t)x * ysize;
+            std::fill(d + row, d + row + ysize, 0.0f);
+            std::fill(e + row, e + row + ysize, 0.0f);
+            if (x < xa || x > xb) continue;
+            const double* up = (x > 0) ? local_u + row - ysize : upper_halo.data();
+            const double* down = (x < local_rows - 1) ? local_u + row + ysize : lower_halo.data();
+            defectRow(d + row, up, local_u + row, down, ysize, 1.0 / dmax);
+        }
+        phaseEnd(timers, PHASE_INTERIOR);
+
+        // The correction is scaled by 1 / dmax, and so is its change between sweeps
+        Convergence scaled;
+        if (check) {
+            scaled = *conv;
+            scaled.tol = conv->tol / dmax;
+        }
+        mpiLaplace(e, ee, local_rows, global_xsize, ysize, sweeps, rank, size, NULL, mode, numThreads,
+                   check ? &scaled : NULL, NULL, NULL, NULL, comm, false, timers, d);
+
+        phaseStart(timers);
+        #pragma omp parallel for num_threads(numThreads) proc_bind(close) if(numThreads > 1)
+        for (int x = 0; x < local_rows; x++) {
+            for (int y = 1; y < ysize - 1; y++) local_u[(size_t)x * ysize + y] += dmax * e[(size_t)x * ysize + y];
+        }
+        phaseEnd(timers, PHASE_INTERIOR);
+        if (check) conv->residual = scaled.residual * dmax;
+        if (check && (scaled.iterations < sweeps || conv->residual < conv->tol)) {
+            done += scaled.iterations;
+            break;
+        }
+        done += sweeps;
+    }
+    if (check) conv->iterations = done;
+    freeAligned(d);
+    freeAligned(e);
+    freeAligned(ee);
+    return verifyStrips(local_u, local_rows, global_xsize, ysize, rank, serial_u, local_reference, norms, comm, timers);
 }
 
 // Save 2D matrix to CSV
-void saveMatrixToCSV(double* matrix, int xsize, int ysize, int size, const std::string& filename) {
+template <typename T>
+void saveMatrixToCSV(T* matrix, int xsize, int ysize, int size, const std::string& filename) {
     std::ofstream file(filename);
     for (int x = 0; x < xsize; x++) {
         for (int y = 0; y < ysize; y++) {
-            file << matrix[x * ysize + y];
+            file << matrix[(size_t)x * ysize + y];
             if (y < ysize - 1) file << ",";
         }
         file << "\n";
@@ -187,19 +1328,319 @@ void printGrid(double* grid, int xsize, int ysize) {
     for (int x = 0; x < xsize; x++) {
         std::cout << "|";
         for (int y = 0; y < ysize; y++) {
-            std::cout << std::fixed << std::setprecision(2) << std::setw(4) << grid[x * ysize + y] << " ";
+            std::cout << std::fixed << std::setprecision(2) << std::setw(4) << grid[(size_t)x * ysize + y] << " ";
         }
         std::cout << "|\n";
     }
     std::cout << "+----------------------------+\n";
 }
 
+// Grid shapes as a comma separated list of "<n>" (n x n) or "<x>x<y>" (x rows of y points)
+bool parseGridList(const std::string& list, std::vector<int>& xsizes, std::vector<int>& ysizes) {
+    std::vector<int> xs, ys;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t sep = item.find('x');
+        int x = std::atoi(item.substr(0, sep).c_str());
+        int y = (sep == std::string::npos) ? x : std::atoi(item.substr(sep + 1).c_str());
+        if (x < 3 || y < 3) return false;
+        xs.push_back(x);
+        ys.push_back(y);
+    }
+    if (xs.empty()) return false;
+    xsizes = xs;
+    ysizes = ys;
+    return true;
+}
+
+// 3D grid shapes as a comma separated list of "<n>" (n x n x n) or "<x>x<y>x<z>"
+bool parseGridList3D(const std::string& list, std::vector<int>& xsizes, std::vector<int>& ysizes,
+                     std::vector<int>& zsizes) {
+    std::vector<int> xs, ys, zs;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t sep1 = item.find('x');
+        size_t sep2 = (sep1 == std::string::npos) ? sep1 : item.find('x', sep1 + 1);
+        int x = std::atoi(item.substr(0, sep1).c_str());
+        int y = x, z = x;
+        if (sep1 != std::string::npos) {
+            if (sep2 == std::string::npos) return false;
+            y = std::atoi(item.substr(sep1 + 1, sep2 - sep1 - 1).c_str());
+            z = std::atoi(item.substr(sep2 + 1).c_str());
+        }
+        if (x < 3 || y < 3 || z < 3) return false;
+        xs.push_back(x);
+        ys.push_back(y);
+        zs.push_back(z);
+    }
+    if (xs.empty()) return false;
+    xsizes = xs;
+    ysizes = ys;
+    zsizes = zs;
+    return true;
+}
+
+// Estimated peak memory per rank for every grid: the two sweep buffers of the largest strip or
+// block (plus the reference strip with distributed verification), and on rank 0 the whole grids
+// of the serial and OpenMP tests or of the MPI tests next to its own strip
+void printMemoryPlan(const std::vector<int>& xsizes, const std::vector<int>& ysizes, int size,
+                     Decomposition decomp, bool distributed) {
+    const double MiB = 1024.0 * 1024.0;
+    std::cout << "Memory per rank (MiB, estimated)\n" << std::left << std::setw(16) << "Grid" << std::right
+              << std::setw(12) << (decomp == DECOMP_CART ? "Block" : "Strip") << std::setw(12) << "Rank 0" << "\n";
+    for (size_t s = 0; s < xsizes.size(); s++) {
+        int xsize = xsizes[s], ysize = ysizes[s];
+        double grid = (double)xsize * ysize * sizeof(double);
+        double local;
+        if (decomp == DECOMP_CART) {
+            int dims[2];
+            cartDims(size, xsize, ysize, dims);
+            int lx = (xsize + dims[0] - 1) / dims[0];
+            int ly = (ysize + dims[1] - 1) / dims[1];
+            local = 2.0 * (lx + 2) * paddedRow(ly + 2) * sizeof(double);
+        } else {
+            int rows = (xsize + size - 1) / size;
+            local = (distributed ? 3.0 : 2.0) * rows * ysize * sizeof(double);
+        }
+        double root = std::max(3.0 * grid, 2.0 * grid + local);
+        std::stringstream ss;
+        ss << xsize << "x" << ysize;
+        std::cout << std::left << std::setw(16) << ss.str() << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << local / MiB << std::setw(12) << root / MiB << "\n";
+    }
+    std::cout << "\n";
+}
+
 int main(int argc, char* argv[]) {
-    MPI_Init(&argc, &argv);
+    // OpenMP reads OMP_PLACES when the program starts, so --places restarts the process before anything runs
+    for (int a = 1; a + 1 < argc; a++) {
+        if (std::string(argv[a]) == "--places") pinThreads(argv[a + 1], argv);
+    }
+
+    // OpenMP threads inside a rank never call MPI, so FUNNELED is all the hybrid mode needs
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    // Command line options: --sizes <n,...> | --grids <n|XxY,...> (grids to run, square or x rows of y points;
+    // 64,128,256,512,1024 by default), --halo blocking|nonblocking|persistent|shared|rma|rma-fence, --decomp strips|cart,
+    // --hybrid (also run MPI with 1..16 OpenMP threads per rank),
+    // --tol <residual> [--check-every <sweeps>] [--norm max|l2] [--overlap-check],
+    // --multigrid v|f [--mg-tol <residual>] (also run serial and MPI multigrid),
+    // --sor [--omega <w>] (also run red-black SOR to --tol, 1e-6 by default; omega 0 picks it from the grid size),
+    // --tiled [--tile-rows <rows>] [--tile-steps <sweeps>] (also run the temporally tiled OpenMP kernel),
+    // --simd auto|scalar|avx2|avx512 (stencil kernel, auto picks the best one the CPU supports),
+    // --output binary|csv|both|none (final MPI grid per size; binary is one MPI-IO file, CSV is gathered on rank 0),
+    // --checkpoint <path> [--checkpoint-every <sweeps>] (checkpoint the MPI solve to <path>_size_<n>.0/.1),
+    // --restart <path> (continue each MPI solve from the newest checkpoint of its size, any rank count),
+    // --verify gather|scatter|file [--reference <path>] (how strip results are checked; file reads
+    // <path>_size_<n>.bin, "reference" by default, and creates it from a serial solve when missing),
+    // --bench strong|weak [--bench-sizes <n,...>] [--bench-ranks <p,...>] [--bench-threads <t,...>]
+    // [--bench-iter <sweeps>] [--warmup <reps>] [--reps <reps>] [--bench-json <file>] [--bench-csv <file>]
+    // (only run a scaling sweep of the strips solver and exit; weak sizes are rows per rank),
+    // --trace <path> [--trace-events <n>] (Chrome trace of each strips MPI solve to <path>_size_<n>.json,
+    // keeping the last <n> events per rank, 65536 by default),
+    // --balance rates|<weights file> [--balance-every <sweeps>] [--balance-threshold <fraction>] (resize the
+    // strips to the measured rates of the ranks, starting from the file's weights if given, see Balance.h),
+    // --placement launch|node|graph (rank order: as launched, grouped by node, or grouped and then reordered
+    // by MPI for the strip chain; cart grids are reordered too unless launch), --places cores|threads|<OMP_PLACES>
+    // (pin OpenMP threads to this rank's cores or hardware threads, see Placement.h),
+    // --touch parallel|serial (OpenMP grids first written by the threads that sweep them, the default, or by one
+    // thread), --huge-pages (2 MiB pages for large grids), --numa-bench [--numa-mb <MiB>] (only measure local and
+    // remote NUMA bandwidth on rank 0's node and exit),
+    // --precision double|float|mixed [--refine-every <sweeps>] (element type of the OpenMP and strips sweeps; mixed
+    // sweeps a float correction and refines the double solution every <sweeps> sweeps, 100 by default),
+    // --source <path> [--boundary <path>] [--bc-x dirichlet|neumann|periodic] [--bc-y dirichlet|neumann|periodic]
+    // (solve -laplace(u) = f with f from <path>_size_<n>.bin, the Dirichlet values and initial grid from the
+    // --boundary file, and the given conditions on the first/last rows (x) and columns (y), see Problem.h),
+    // --grids-3d <n|XxYxZ,...> [--iter-3d <sweeps>] [--tile-3d <rows>] (also run the 7-point 3D Jacobi solver on a
+    // 3D process grid, SMALL_ITER sweeps by default; --halo picks its exchange, tile 0 sizes y tiles to L2)
+    std::vector<int> sizes = {64, 128, 256, 512, 1024};
+    std::vector<int> widths = sizes;
+    HaloMode halo_mode = HALO_BLOCKING;
+    Decomposition decomp = DECOMP_STRIPS;
+    bool hybrid = false;
+    Convergence conv = {0.0, 100, false, false, 0, 0.0};
+    bool multigrid = false;
+    MultigridOptions mg_opts = {MG_VCYCLE, 2, 2, 1e-10, 100};
+    bool sor = false;
+    double omega = 0.0;
+    bool tiled = false;
+    int tile_rows = 32;
+    int tile_steps = 8;
+    SimdLevel simd_level = detectSimdLevel();
+    bool write_binary = true;
+    bool write_csv = false;
+    std::string checkpoint_path, restart_path;
+    int checkpoint_every = 1000;
+    VerifyMode verify = VERIFY_GATHER;
+    std::string reference_path = "reference";
+    std::string trace_path;
+    int trace_events = 65536;
+    std::string balance_source;
+    BalanceOptions balance;
+    RankPlacement placement = PLACE_LAUNCH;
+    std::string places;
+    balance.every = 500;
+    balance.threshold = 0.05;
+    balance.migrations = 0;
+    bool benchmark = false;
+    bool parallel_touch = true;
+    bool huge_pages = false;
+    bool numa_bench = false;
+    int numa_mb = 256;
+    Precision precision = PRECISION_DOUBLE;
+    int refine_every = 100;
+    Problem problem = {{BOUNDARY_DIRICHLET, BOUNDARY_DIRICHLET}, "", ""};
+    std::vector<int> sizes_3d, widths_3d, depths_3d;
+    int iter_3d = SMALL_ITER;
+    int tile_3d = 0;
+    BenchmarkOptions bench_opts;
+    bench_opts.scaling = SCALING_STRONG;
+    bench_opts.sizes = {256, 512, 1024};
+    bench_opts.thread_counts = {1};
+    bench_opts.iterations = 1000;
+    bench_opts.warmup = 1;
+    bench_opts.repetitions = 5;
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        if ((arg == "--sizes" || arg == "--grids") && a + 1 < argc) {
+            if (!parseGridList(argv[++a], sizes, widths) && rank == 0) {
+                std::cerr << "Invalid grid list '" << argv[a] << "', grids need at least 3x3 points\n";
+            }
+        } else if (arg == "--halo" && a + 1 < argc) {
+            if (!parseHaloMode(argv[++a], halo_mode) && rank == 0) {
+                std::cerr << "Unknown halo mode '" << argv[a] << "', using " << haloModeName(halo_mode) << "\n";
+            }
+        } else if (arg == "--hybrid") {
+            hybrid = true;
+        } else if (arg == "--tol" && a + 1 < argc) {
+            conv.tol = std::atof(argv[++a]);
+        } else if (arg == "--check-every" && a + 1 < argc) {
+            conv.check_every = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--norm" && a + 1 < argc) {
+            conv.use_l2 = std::string(argv[++a]) == "l2";
+        } else if (arg == "--overlap-check") {
+            conv.overlap = true;
+        } else if (arg == "--multigrid" && a + 1 < argc) {
+            multigrid = true;
+            mg_opts.cycle = (std::string(argv[++a]) == "f") ? MG_FCYCLE : MG_VCYCLE;
+        } else if (arg == "--mg-tol" && a + 1 < argc) {
+            mg_opts.tol = std::atof(argv[++a]);
+        } else if (arg == "--sor") {
+            sor = true;
+        } else if (arg == "--omega" && a + 1 < argc) {
+            omega = std::atof(argv[++a]);
+        } else if (arg == "--simd" && a + 1 < argc) {
+            if (!parseSimdLevel(argv[++a], simd_level) && rank == 0) {
+                std::cerr << "Unknown SIMD level '" << argv[a] << "', using " << simdLevelName(simd_level) << "\n";
+            }
+        } else if (arg == "--output" && a + 1 < argc) {
+            std::string format = argv[++a];
+            write_binary = format == "binary" || format == "both";
+            write_csv = format == "csv" || format == "both";
+        } else if (arg == "--checkpoint" && a + 1 < argc) {
+            checkpoint_path = argv[++a];
+        } else if (arg == "--checkpoint-every" && a + 1 < argc) {
+            checkpoint_every = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--restart" && a + 1 < argc) {
+            restart_path = argv[++a];
+        } else if (arg == "--verify" && a + 1 < argc) {
+            if (!parseVerifyMode(argv[++a], verify) && rank == 0) {
+                std::cerr << "Unknown verification mode '" << argv[a] << "', using " << verifyModeName(verify) << "\n";
+            }
+        } else if (arg == "--reference" && a + 1 < argc) {
+            reference_path = argv[++a];
+        } else if (arg == "--trace" && a + 1 < argc) {
+            trace_path = argv[++a];
+        } else if (arg == "--trace-events" && a + 1 < argc) {
+            trace_events = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--balance" && a + 1 < argc) {
+            balance_source = argv[++a];
+        } else if (arg == "--balance-every" && a + 1 < argc) {
+            balance.every = std::max(0, std::atoi(argv[++a]));
+        } else if (arg == "--balance-threshold" && a + 1 < argc) {
+            balance.threshold = std::max(0.0, std::atof(argv[++a]));
+        } else if (arg == "--placement" && a + 1 < argc) {
+            if (!parseRankPlacement(argv[++a], placement) && rank == 0) {
+                std::cerr << "Unknown placement '" << argv[a] << "', using " << rankPlacementName(placement) << "\n";
+            }
+        } else if (arg == "--places" && a + 1 < argc) {
+            places = argv[++a];
+        } else if (arg == "--touch" && a + 1 < argc) {
+            parallel_touch = std::string(argv[++a]) != "serial";
+        } else if (arg == "--huge-pages") {
+            huge_pages = true;
+        } else if (arg == "--numa-bench") {
+            numa_bench = true;
+        } else if (arg == "--numa-mb" && a + 1 < argc) {
+            numa_mb = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--precision" && a + 1 < argc) {
+            if (!parsePrecision(argv[++a], precision) && rank == 0) {
+                std::cerr << "Unknown precision '" << argv[a] << "', using " << precisionName(precision) << "\n";
+            }
+        } else if (arg == "--refine-every" && a + 1 < argc) {
+            refine_every = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--source" && a + 1 < argc) {
+            problem.source_path = argv[++a];
+        } else if (arg == "--boundary" && a + 1 < argc) {
+            problem.values_path = argv[++a];
+        } else if ((arg == "--bc-x" || arg == "--bc-y") && a + 1 < argc) {
+            BoundaryKind& kind = (arg == "--bc-x") ? problem.boundaries.x : problem.boundaries.y;
+            if (!parseBoundaryKind(argv[++a], kind) && rank == 0) {
+                std::cerr << "Unknown boundary condition '" << argv[a] << "', using " << boundaryKindName(kind) << "\n";
+            }
+        } else if (arg == "--bench" && a + 1 < argc) {
+            benchmark = true;
+            if (!parseScalingMode(argv[++a], bench_opts.scaling) && rank == 0) {
+                std::cerr << "Unknown scaling mode '" << argv[a] << "', using " << scalingModeName(bench_opts.scaling) << "\n";
+            }
+        } else if (arg == "--bench-sizes" && a + 1 < argc) {
+            bench_opts.sizes = parseIntList(argv[++a]);
+        } else if (arg == "--bench-ranks" && a + 1 < argc) {
+            bench_opts.rank_counts = parseIntList(argv[++a]);
+        } else if (arg == "--bench-threads" && a + 1 < argc) {
+            bench_opts.thread_counts = parseIntList(argv[++a]);
+        } else if (arg == "--bench-iter" && a + 1 < argc) {
+            bench_opts.iterations = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--warmup" && a + 1 < argc) {
+            bench_opts.warmup = std::max(0, std::atoi(argv[++a]));
+        } else if (arg == "--reps" && a + 1 < argc) {
+            bench_opts.repetitions = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--bench-json" && a + 1 < argc) {
+            bench_opts.json_path = argv[++a];
+        } else if (arg == "--bench-csv" && a + 1 < argc) {
+            bench_opts.csv_path = argv[++a];
+        } else if (arg == "--tiled") {
+            tiled = true;
+        } else if (arg == "--tile-rows" && a + 1 < argc) {
+            tile_rows = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--tile-steps" && a + 1 < argc) {
+            tile_steps = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--grids-3d" && a + 1 < argc) {
+            if (!parseGridList3D(argv[++a], sizes_3d, widths_3d, depths_3d) && rank == 0) {
+                std::cerr << "Invalid 3D grid list '" << argv[a] << "', grids need at least 3x3x3 points\n";
+            }
+        } else if (arg == "--iter-3d" && a + 1 < argc) {
+            iter_3d = std::max(1, std::atoi(argv[++a]));
+        } else if (arg == "--tile-3d" && a + 1 < argc) {
+            tile_3d = std::max(0, std::atoi(argv[++a]));
+        } else if (arg == "--decomp" && a + 1 < argc) {
+            if (!parseDecomposition(argv[++a], decomp) && rank == 0) {
+                std::cerr << "Unknown decomposition '" << argv[a] << "', using " << decompositionName(decomp) << "\n";
+            }
+        }
+    }
+
+    // Every MPI solve below runs on the ranks in placement order
+    MPI_Comm world = placeRanks(placement, MPI_COMM_WORLD);
+    MPI_Comm_rank(world, &rank);
+    bool reorder = placement != PLACE_LAUNCH;
+
     // Collect node names (for potential debugging, but don't print)
     char processor_name[MPI_MAX_PROCESSOR_NAME];
     int name_len;
@@ -209,12 +1650,187 @@ int main(int argc, char* argv[]) {
     char* all_names = NULL;
     if (rank == 0) all_names = new char[size * MPI_MAX_PROCESSOR_NAME];
     MPI_Gather(processor_name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
-               all_names, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, MPI_COMM_WORLD);
+               all_names, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, world);
+
+    SimdLevel requested_simd = simd_level;
+    simd_level = setSimdLevel(simd_level);
+    if (simd_level != requested_simd && rank == 0) {
+        std::cerr << "CPU lacks " << simdLevelName(requested_simd) << ", using " << simdLevelName(simd_level) << "\n";
+    }
+    setHugePages(huge_pages);
+
+    if ((halo_mode == HALO_SHARED || halo_mode == HALO_RMA || halo_mode == HALO_RMA_FENCE) && decomp == DECOMP_CART) {
+        if (rank == 0) std::cerr << haloModeName(halo_mode) << " halos need the strips decomposition, using blocking\n";
+        halo_mode = HALO_BLOCKING;
+    }
+
+    if (verify != VERIFY_GATHER && decomp == DECOMP_CART) {
+        if (rank == 0) std::cerr << "Distributed verification needs the strips decomposition, using gather\n";
+        verify = VERIFY_GATHER;
+    }
+
+    bool balancing = !balance_source.empty();
+    if (balancing && decomp == DECOMP_CART) {
+        if (rank == 0) std::cerr << "Load balancing needs the strips decomposition, disabled\n";
+        balancing = false;
+    }
+    if (balancing && (!checkpoint_path.empty() || !restart_path.empty())) {
+        if (rank == 0) std::cerr << "Checkpoints are not supported with load balancing, disabled\n";
+        checkpoint_path.clear();
+        restart_path.clear();
+    }
+    if (balancing && balance_source != "rates") {
+        balance.weights = readBalanceWeights(balance_source, world);
+        if (balance.weights.empty() && rank == 0) {
+            std::cerr << "Could not read weights " << balance_source << ", starting from an even split\n";
+        }
+    }
+
+    // Only the Jacobi solvers take a problem; the others keep solving the built-in one
+    bool builtin_problem = isBuiltinProblem(problem);
+    if (!builtin_problem) {
+        if (balancing) {
+            if (rank == 0) std::cerr << "Load balancing needs the built-in problem, disabled\n";
+            balancing = false;
+        }
+        if (precision != PRECISION_DOUBLE) {
+            if (rank == 0) std::cerr << precisionName(precision) << " precision needs the built-in problem, using double\n";
+            precision = PRECISION_DOUBLE;
+        }
+        if (tiled) {
+            if (rank == 0) std::cerr << "The tiled kernel needs the built-in problem, disabled\n";
+            tiled = false;
+        }
+        if (verify == VERIFY_FILE) {
+            if (rank == 0) std::cerr << "Reference files hold the built-in problem, using scatter verification\n";
+            verify = VERIFY_SCATTER;
+        }
+    }
+
+    if (precision != PRECISION_DOUBLE && (decomp == DECOMP_CART || balancing)) {
+        if (rank == 0) {
+            std::cerr << precisionName(precision) << " precision needs the strips decomposition without load balancing, using double\n";
+        }
+        precision = PRECISION_DOUBLE;
+    }
+    if (precision == PRECISION_MIXED && (!checkpoint_path.empty() || !restart_path.empty())) {
+        if (rank == 0) std::cerr << "Checkpoints are not supported with mixed precision, disabled\n";
+        checkpoint_path.clear();
+        restart_path.clear();
+    }
+
+    if (hybrid && provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) std::cerr << "MPI library lacks MPI_THREAD_FUNNELED support, hybrid mode disabled\n";
+        hybrid = false;
+    }
 
     if (rank == 0) {
-        std::cout << "MPI on " << size << " process(es):\n\n";
+        std::cout << "MPI on " << size << " process(es), " << decompositionName(decomp) << " decomposition, "
+                  << haloModeName(halo_mode) << " halo exchange, " << simdLevelName(simd_level) << " stencil kernel:\n\n";
+        if (conv.tol > 0.0) {
+            std::cout << "MPI solvers stop at " << (conv.use_l2 ? "L2" : "max") << " residual < " << std::scientific
+                      << std::setprecision(2) << conv.tol << ", checked every " << conv.check_every << " sweeps"
+                      << (conv.overlap ? " with MPI_Iallreduce" : "") << "\n\n";
+        }
+        if (multigrid) {
+            std::cout << "Multigrid " << mgCycleName(mg_opts.cycle) << ", red-black Gauss-Seidel smoother, max residual < "
+                      << std::scientific << std::setprecision(2) << mg_opts.tol << "\n\n";
+        }
+        if (sor) {
+            std::cout << "Red-black SOR, omega " << (omega > 0.0 ? "fixed" : "from grid size") << ", max change < "
+                      << std::scientific << std::setprecision(2) << (conv.tol > 0.0 ? conv.tol : 1e-6) << "\n\n";
+        }
+        if (verify != VERIFY_GATHER) {
+            std::cout << "Distributed verification, reference strips from "
+                      << (verify == VERIFY_FILE ? reference_path + "_size_<n>.bin" : std::string("MPI_Scatterv")) << "\n\n";
+        }
+        if (!checkpoint_path.empty()) {
+            std::cout << "Checkpoints every " << checkpoint_every << " sweeps to " << checkpoint_path << "_size_<n>.0/.1\n\n";
+        }
+        if (!trace_path.empty()) {
+            std::cout << "Tracing MPI solves to " << trace_path << "_size_<n>.json, last " << trace_events << " events per rank\n\n";
+        }
+        if (balancing) {
+            std::cout << "Load balancing every " << balance.every << " sweeps above " << std::fixed << std::setprecision(0)
+                      << balance.threshold * 100 << "% imbalance, starting from "
+                      << (balance.weights.empty() ? std::string("an even split") : "weights in " + balance_source) << "\n\n";
+        }
+        if (!restart_path.empty()) {
+            std::cout << "Restarting from " << restart_path << "_size_<n>.0/.1 where present\n\n";
+        }
+        if (precision != PRECISION_DOUBLE) {
+            std::cout << "OpenMP and MPI sweeps in " << (precision == PRECISION_FLOAT ? "float" : "float, refined in double every ");
+            if (precision == PRECISION_MIXED) std::cout << refine_every << " sweeps";
+            std::cout << ", compared with the double serial solve\n\n";
+        }
+        if (!builtin_problem) {
+            std::cout << "Poisson problem, f from " << (problem.source_path.empty() ? std::string("none (f = 0)") : problem.source_path + "_size_<n>.bin")
+                      << ", boundary values from " << (problem.values_path.empty() ? std::string("the built-in grid") : problem.values_path + "_size_<n>.bin")
+                      << ", " << boundaryKindName(problem.boundaries.x) << " x sides, " << boundaryKindName(problem.boundaries.y)
+                      << " y sides" << ((multigrid || sor) ? "; multigrid and SOR solve the built-in problem" : "") << "\n\n";
+        }
+        if (tiled) {
+            std::cout << "Temporally tiled OpenMP kernel, " << std::max(tile_rows, 2 * tile_steps) << "-row tiles, "
+                      << tile_steps << " sweeps per tile\n\n";
+        }
+        if (huge_pages || !parallel_touch) {
+            std::cout << "Grids " << (huge_pages ? "of 2 MiB or more on transparent huge pages, " : "")
+                      << "OpenMP grids first touched by " << (parallel_touch ? "the sweeping threads" : "one thread") << "\n\n";
+        }
+        printMemoryPlan(sizes, widths, size, decomp, verify != VERIFY_GATHER);
+        if (hybrid) {
+            std::cout << "Hybrid MPI+OpenMP, " << omp_get_num_places() << " OpenMP place(s) per rank";
+            if (omp_get_num_places() == 0) std::cout << " (use --places cores to pin threads)";
+            std::cout << "\n\n";
+        }
         delete[] all_names;
     }
+    if (placement != PLACE_LAUNCH || !places.empty()) printPlacement(placement, world, MPI_COMM_WORLD);
+
+    // NUMA bandwidth only, on the node of rank 0
+    if (numa_bench) {
+        if (rank == 0) runNumaBenchmark(numa_mb, 5);
+        MPI_Comm_free(&world);
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Scaling sweep only: every repetition times the strips solver on fresh grids, without verification
+    if (benchmark) {
+        if (decomp == DECOMP_CART && rank == 0) std::cerr << "Benchmark mode times the strips decomposition\n";
+        if (provided < MPI_THREAD_FUNNELED) bench_opts.thread_counts = std::vector<int>(1, 1);
+        bench_opts.label = std::string("strips/") + haloModeName(halo_mode) + "/" + simdLevelName(simd_level);
+        BenchmarkSolver solver = [&](MPI_Comm comm, int bx, int by, int iters, int threads) {
+            int r, p;
+            MPI_Comm_rank(comm, &r);
+            MPI_Comm_size(comm, &p);
+            int rows = bx / p + (r < bx % p ? 1 : 0);
+            int row0 = r * (bx / p) + std::min(r, bx % p);
+            double* u = allocAligned((size_t)std::max(rows, 1) * by);
+            double* uu = allocAligned((size_t)std::max(rows, 1) * by);
+            initializeRows(u, row0, rows, bx, by);
+            MPI_Barrier(comm);
+            double t0 = MPI_Wtime();
+            mpiLaplace(u, uu, rows, bx, by, iters, r, p, NULL, halo_mode, threads, NULL, NULL, NULL, NULL, comm, false);
+            double seconds = MPI_Wtime() - t0;
+            freeAligned(u);
+            freeAligned(uu);
+            return seconds;
+        };
+        std::vector<BenchmarkResult> results = runBenchmark(bench_opts, solver, world);
+        if (rank == 0) {
+            printBenchmark(bench_opts, results);
+            if (!bench_opts.json_path.empty() && !writeBenchmarkJSON(bench_opts.json_path, bench_opts, results)) {
+                std::cerr << "Could not write " << bench_opts.json_path << "\n";
+            }
+            if (!bench_opts.csv_path.empty() && !writeBenchmarkCSV(bench_opts.csv_path, bench_opts, results)) {
+                std::cerr << "Could not write " << bench_opts.csv_path << "\n";
+            }
+        }
+        MPI_Comm_free(&world);
+        MPI_Finalize();
+        return 0;
+    }
 
     // Test 4x4 grid
     const int small_size = 4;
@@ -269,10 +1885,16 @@ int main(int argc, char* argv[]) {
         initializeGrid(local_u, local_rows, small_size);
     }
 
-    MPI_Scatterv(global_u, &counts[0], &displs[0], MPI_DOUBLE,
-                 local_u, local_rows * small_size, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-
-    double diff_mpi = mpiLaplace(local_u, local_uu, local_rows, small_size, small_size, SMALL_ITER, rank, size, serial_u);
+    double diff_mpi;
+    if (decomp == DECOMP_CART) {
+        diff_mpi = mpiLaplace2D(global_u, small_size, small_size, SMALL_ITER, rank, size, serial_u, halo_mode, 1, NULL,
+                                NULL, NULL, NULL, world, reorder);
+    } else {
+        MPI_Scatterv(global_u, &counts[0], &displs[0], MPI_DOUBLE,
+                     local_u, local_rows * small_size, MPI_DOUBLE, 0, world);
+        diff_mpi = mpiLaplace(local_u, local_uu, local_rows, small_size, small_size, SMALL_ITER, rank, size, serial_u, halo_mode,
+                              1, NULL, NULL, NULL, NULL, world);
+    }
 
     if (rank == 0) {
         std::cout << "MPI (1 process) vs Serial Diff: " << std::scientific << std::setprecision(2) << diff_mpi << "\n\n";
@@ -285,59 +1907,145 @@ int main(int argc, char* argv[]) {
     delete[] local_uu;
 
     // Performance tests
-    std::vector<int> sizes = {64, 128, 256, 512, 1024};
     std::vector<int> thread_counts = {1, 2, 4, 8, 16};
     std::vector<double> serial_times(sizes.size());
     std::vector<std::vector<double>> omp_times(thread_counts.size(), std::vector<double>(sizes.size()));
     std::vector<double> mpi_times(sizes.size());
+    std::vector<double> checkpoint_times(sizes.size());
+    std::vector<PhaseStats> phase_stats(sizes.size());
+    std::vector<std::vector<double>> hybrid_times(thread_counts.size(), std::vector<double>(sizes.size()));
+    std::vector<double> mg_times(sizes.size()), mpi_mg_times(sizes.size());
+    std::vector<double> sor_times(sizes.size()), mpi_sor_times(sizes.size());
+    std::vector<std::vector<double>> omp_sor_times(thread_counts.size(), std::vector<double>(sizes.size()));
+    std::vector<int> sor_iters(sizes.size());
+    std::vector<std::vector<double>> tiled_times(thread_counts.size(), std::vector<double>(sizes.size()));
 
     for (size_t s = 0; s < sizes.size(); s++) {
         int xsize = sizes[s];
-        int ysize = xsize;
+        int ysize = widths[s];
+        // File names keep "<n>" for square grids and use "<x>x<y>" for rectangular ones
+        std::stringstream ss_tag;
+        ss_tag << xsize;
+        if (ysize != xsize) ss_tag << "x" << ysize;
+        std::string grid_tag = ss_tag.str();
+        MPI_Datatype row_type = rowType(ysize);
+
+        // The problem's scaled source and initial values, whole grids on rank 0
+        double* problem_source = NULL;
+        double* problem_values = NULL;
+        if (rank == 0 && !builtin_problem) {
+            problem_source = new double[(size_t)xsize * ysize];
+            problem_values = new double[(size_t)xsize * ysize];
+            if (!readProblemSource(problem, problem_source, ysize, 0, xsize, 0, ysize, xsize, ysize, MPI_COMM_SELF)) {
+                if (!problem.source_path.empty()) {
+                    std::cerr << "Could not read " << problemFile(problem.source_path, xsize, ysize) << ", using f = 0\n";
+                }
+                delete[] problem_source;
+                problem_source = NULL;
+            }
+            if (!readProblemValues(problem, problem_values, ysize, 0, xsize, 0, ysize, xsize, ysize, MPI_COMM_SELF)) {
+                if (!problem.values_path.empty()) {
+                    std::cerr << "Could not read " << problemFile(problem.values_path, xsize, ysize)
+                              << ", using the built-in boundary values\n";
+                }
+                delete[] problem_values;
+                problem_values = NULL;
+            }
+        }
+        // Initial grid of the problem, first touched by numThreads threads as in initializeGrid
+        auto initializeProblem = [&](double* grid, int numThreads) {
+            initializeGrid(grid, xsize, ysize, numThreads);
+            if (problem_values) std::copy(problem_values, problem_values + (size_t)xsize * ysize, grid);
+        };
 
         // Serial tests
         if (rank == 0) {
             std::cout << "Serial Tests\n";
-            double* u = new double[xsize * ysize];
-            double* uu = new double[xsize * ysize];
-            initializeGrid(u, xsize, ysize);
+            // Aligned so every row of these widths (multiples of 8 doubles) starts on a 64-byte boundary
+            double* u = allocAligned((size_t)xsize * ysize);
+            double* uu = allocAligned((size_t)xsize * ysize);
+            initializeProblem(u, 1);
             Clock.Start();
-            serialLaplace(u, uu, xsize, ysize, ITER);
+            serialLaplace(u, uu, xsize, ysize, ITER, problem_source, problem.boundaries);
             Clock.Stop();
             serial_times[s] = Clock.ElapsedTime() / 1000.0;
             std::stringstream ss;
-            ss << xsize << "x" << xsize;
+            ss << xsize << "x" << ysize;
             std::cout << std::left << std::setw(8) << "Serial" << "Size " << std::setw(9) << ss.str()
                       << "Time " << std::fixed << std::setprecision(2) << serial_times[s] << "s\n";
-            delete[] u;
-            delete[] uu;
+            freeAligned(u);
+            freeAligned(uu);
         }
 
-        // OpenMP tests
+        // OpenMP tests. Every thread count gets fresh grids, so their pages are placed by its first touch
         if (rank == 0) {
             std::cout << "OpenMP Tests\n";
-            double* u = new double[xsize * ysize];
-            double* uu = new double[xsize * ysize];
-            double* serial_u = new double[xsize * ysize];
-            initializeGrid(u, xsize, ysize);
-            initializeGrid(serial_u, xsize, ysize);
-            serialLaplace(serial_u, uu, xsize, ysize, ITER);
+            double* serial_u = new double[(size_t)xsize * ysize];
+            double* scratch = new double[(size_t)xsize * ysize];
+            initializeProblem(serial_u, 1);
+            serialLaplace(serial_u, scratch, xsize, ysize, ITER, problem_source, problem.boundaries);
+            delete[] scratch;
             for (size_t t = 0; t < thread_counts.size(); t++) {
-                initializeGrid(u, xsize, ysize);
-                Clock.Start();
-                double diff_omp = openMPLaplace(u, uu, xsize, ysize, ITER, thread_counts[t], serial_u);
-                Clock.Stop();
+                int touch_threads = parallel_touch ? thread_counts[t] : 1;
+                double diff_omp;
+                if (precision == PRECISION_FLOAT) {
+                    float* u = allocAlignedAs<float>((size_t)xsize * ysize);
+                    float* uu = allocAlignedAs<float>((size_t)xsize * ysize);
+                    initializeGrid(u, xsize, ysize, touch_threads);
+                    Clock.Start();
+                    diff_omp = openMPLaplace(u, uu, xsize, ysize, ITER, thread_counts[t], serial_u);
+                    Clock.Stop();
+                    freeAligned(u);
+                    freeAligned(uu);
+                } else {
+                    double* u = allocAligned((size_t)xsize * ysize);
+                    double* uu = allocAligned((size_t)xsize * ysize);
+                    initializeProblem(u, touch_threads);
+                    Clock.Start();
+                    if (precision == PRECISION_MIXED) {
+                        diff_omp = openMPMixedLaplace(u, xsize, ysize, ITER, thread_counts[t], refine_every, serial_u);
+                    } else {
+                        diff_omp = openMPLaplace(u, uu, xsize, ysize, ITER, thread_counts[t], serial_u,
+                                                 problem_source, problem.boundaries);
+                    }
+                    Clock.Stop();
+                    freeAligned(u);
+                    freeAligned(uu);
+                }
                 omp_times[t][s] = Clock.ElapsedTime() / 1000.0;
                 std::stringstream ss_size, ss_threads;
-                ss_size << xsize << "x" << xsize;
+                ss_size << xsize << "x" << ysize;
                 ss_threads << thread_counts[t];
                 std::cout << std::left << std::setw(8) << "OpenMP" << "Size " << std::setw(9) << ss_size.str()
                           << "Thr " << std::setw(2) << ss_threads.str()
                           << " Diff " << std::scientific << std::setprecision(2) << diff_omp
                           << " Time " << std::fixed << std::setprecision(2) << omp_times[t][s] << "s\n";
             }
-            delete[] u;
-            delete[] uu;
+
+            // Tiled tests: same sweeps as OpenMP, so the result must match it exactly
+            if (tiled) {
+                std::cout << "Tiled Tests\n";
+            }
+            for (size_t t = 0; tiled && t < thread_counts.size(); t++) {
+                double* u = allocAligned((size_t)xsize * ysize);
+                double* uu = allocAligned((size_t)xsize * ysize);
+                initializeGrid(u, xsize, ysize, parallel_touch ? thread_counts[t] : 1);
+                Clock.Start();
+                double diff_tiled = tiledLaplace(u, uu, xsize, ysize, ITER, thread_counts[t], tile_rows, tile_steps, serial_u);
+                Clock.Stop();
+                tiled_times[t][s] = Clock.ElapsedTime() / 1000.0;
+                bool exact = std::equal(u, u + (size_t)xsize * ysize, serial_u);
+                std::stringstream ss_size, ss_threads;
+                ss_size << xsize << "x" << ysize;
+                ss_threads << thread_counts[t];
+                std::cout << std::left << std::setw(8) << "Tiled" << "Size " << std::setw(9) << ss_size.str()
+                          << "Thr " << std::setw(2) << ss_threads.str()
+                          << " Diff " << std::scientific << std::setprecision(2) << diff_tiled
+                          << " Exact " << (exact ? "yes" : "no")
+                          << " Time " << std::fixed << std::setprecision(2) << tiled_times[t][s] << "s\n";
+                freeAligned(u);
+                freeAligned(uu);
+            }
             delete[] serial_u;
         }
 
@@ -349,79 +2057,523 @@ int main(int argc, char* argv[]) {
             int rows_per_proc = xsize / size;
             int remainder = xsize % size;
             int local_rows = rows_per_proc + (rank < remainder ? 1 : 0);
+            std::vector<int> counts(size), displs(size);
+            int offset = 0;
+            for (int i = 0; i < size; i++) {
+                int rows = rows_per_proc + (i < remainder ? 1 : 0);
+                counts[i] = rows;
+                displs[i] = offset;
+                offset += counts[i];
+            }
+            int row0 = displs[rank];
+
+            // With distributed verification each rank starts from its own strip and gets its strip
+            // of the reference; rank 0 only needs the whole grid for CSV output or a missing reference file
+            bool distributed = verify != VERIFY_GATHER;
+            std::stringstream ss_ref;
+            ss_ref << reference_path << "_size_" << grid_tag << ".bin";
+            std::string reference_file = ss_ref.str();
+            bool need_serial = verify != VERIFY_FILE ||
+                               gridFileIterations(reference_file.c_str(), xsize, ysize, world) != ITER;
             double* global_u = NULL;
             double* serial_u = NULL;
+            if (rank == 0 && (!distributed || write_csv || need_serial)) {
+                global_u = new double[(size_t)xsize * ysize];
+            }
+            if (rank == 0 && need_serial) {
+                serial_u = new double[(size_t)xsize * ysize];
+                initializeProblem(global_u, 1);
+                initializeProblem(serial_u, 1);
+                serialLaplace(serial_u, global_u, xsize, ysize, ITER, problem_source, problem.boundaries);
+                if (verify == VERIFY_FILE) {
+                    writeGridMPIIO(reference_file.c_str(), serial_u, ysize, 0, xsize, 0, ysize, xsize, ysize, ITER, MPI_COMM_SELF);
+                    std::cout << "Wrote reference " << reference_file << "\n";
+                }
+            }
+
+            double* local_ref = NULL;
+            if (distributed) {
+                local_ref = new double[(size_t)local_rows * ysize];
+                if (verify == VERIFY_SCATTER) {
+                    MPI_Scatterv(serial_u, &counts[0], &displs[0], row_type,
+                                 local_ref, local_rows, row_type, 0, world);
+                } else {
+                    MPI_Barrier(world); // Rank 0 may have just written the file
+                    readGridMPIIO(reference_file.c_str(), local_ref, ysize, row0, local_rows, 0, ysize,
+                                  xsize, ysize, world);
+                }
+            }
+
+            double* local_u = allocAligned((size_t)local_rows * ysize);
+            double* local_uu = allocAligned((size_t)local_rows * ysize);
+            // Each rank reads its own strip of the source
+            double* local_source = NULL;
+            if (!builtin_problem) {
+                local_source = allocAligned((size_t)local_rows * ysize);
+                if (!readProblemSource(problem, local_source, ysize, row0, local_rows, 0, ysize, xsize, ysize, world)) {
+                    freeAligned(local_source);
+                    local_source = NULL;
+                }
+            }
+            // Float strips are swept apart from local_u, which holds the initial state and the widened result
+            float* local_f = NULL;
+            float* local_ff = NULL;
+            if (precision == PRECISION_FLOAT) {
+                local_f = allocAlignedAs<float>((size_t)local_rows * ysize);
+                local_ff = allocAlignedAs<float>((size_t)local_rows * ysize);
+            }
+            std::stringstream ss_file;
+            ss_file << "global_u_size_" << grid_tag << "_procs_" << size;
+            std::string binary_file = ss_file.str() + ".bin";
+
+            // Checkpoints of this size, and the newest complete one to restart from
+            std::stringstream ss_ckpt;
+            ss_ckpt << "_size_" << grid_tag;
+            Checkpoint ckpt = {checkpoint_path + ss_ckpt.str(), checkpoint_path.empty() ? 0 : checkpoint_every,
+                               0, 0, 0.0, 0, AsyncGridWrite()};
+            std::string restart_file;
+            if (!restart_path.empty()) {
+                Checkpoint from = ckpt;
+                from.path = restart_path + ss_ckpt.str();
+                int restart_iter;
+                int slot = latestCheckpoint(&from, xsize, ysize, &restart_iter, world);
+                if (slot >= 0 && restart_iter <= ITER) {
+                    restart_file = checkpointFile(&from, slot);
+                    ckpt.start = restart_iter;
+                    ckpt.slot = 1 - slot; // Keep the restart file until a newer checkpoint is complete
+                }
+            }
+
+            // Run the selected MPI solver from the initial grid, return the slowest rank's time.
+            // With output set the result is also written to that binary file, which is not timed.
+            // With run_ckpt set the solve checkpoints and, if there is a restart file, starts from it.
+            // With timers set the strips solver adds its per-phase times to them.
+            double write_time = 0.0;
+            DiffNorms norms = {0.0, 0.0, 0.0};
+            auto runMPI = [&](int numThreads, double& diff, const char* output, Checkpoint* run_ckpt, PhaseTimers* timers) {
+                if (global_u) initializeProblem(global_u, 1);
+                bool restart = run_ckpt != NULL && !restart_file.empty();
+                double local_write = 0.0;
+                if (decomp == DECOMP_CART) {
+                    // The cart solver scatters global_u itself, so rank 0 reads the whole grid
+                    if (restart) {
+                        readGridMPIIO(restart_file.c_str(), global_u, ysize, 0, rank == 0 ? xsize : 0, 0, ysize,
+                                      xsize, ysize, world);
+                    }
+                    Clock.Start();
+                    diff = mpiLaplace2D(global_u, xsize, ysize, ITER, rank, size, serial_u, halo_mode, numThreads, &conv,
+                                        output, &local_write, run_ckpt, world, reorder, problem_source, problem.boundaries);
+                    Clock.Stop();
+                } else {
+                    if (distributed) {
+                        initializeRows(local_u, row0, local_rows, xsize, ysize);
+                        readProblemValues(problem, local_u, ysize, row0, local_rows, 0, ysize, xsize, ysize, world);
+                    } else {
+                        MPI_Scatterv(global_u, &counts[0], &displs[0], row_type,
+                                     local_u, local_rows, row_type, 0, world);
+                    }
+                    if (restart) {
+                        readGridMPIIO(restart_file.c_str(), local_u, ysize, row0, local_rows, 0, ysize,
+                                      xsize, ysize, world);
+                    }
+
+                    if (local_f) std::copy(local_u, local_u + (size_t)local_rows * ysize, local_f);
+
+                    Clock.Start();
+                    if (balancing) {
+                        diff = balancedLaplace(local_u, local_rows, xsize, ysize, ITER, rank, size, serial_u, halo_mode,
+                                               numThreads, &conv, &balance, local_ref, &norms, timers, world);
+                    } else if (precision == PRECISION_FLOAT) {
+                        diff = mpiLaplace(local_f, local_ff, local_rows, xsize, ysize, ITER, rank, size, serial_u, halo_mode,
+                                          numThreads, &conv, run_ckpt, local_ref, &norms, world, true, timers);
+                    } else if (precision == PRECISION_MIXED) {
+                        diff = mpiMixedLaplace(local_u, local_rows, xsize, ysize, ITER, rank, size, serial_u, halo_mode,
+                                               numThreads, refine_every, &conv, local_ref, &norms, world, timers);
+                    } else {
+                        diff = mpiLaplace(local_u, local_uu, local_rows, xsize, ysize, ITER, rank, size, serial_u, halo_mode,
+                                          numThreads, &conv, run_ckpt, local_ref, &norms, world, true, timers,
+                                          local_source, problem.boundaries);
+                    }
+                    Clock.Stop();
+                    // Float results are written as float32 files
+                    if (output) {
+                        int iterations = (conv.tol > 0.0) ? conv.iterations : ITER;
+                        local_write = local_f ? writeGridMPIIO(output, local_f, ysize, row0, local_rows, 0, ysize,
+                                                               xsize, ysize, iterations, world)
+                                              : writeGridMPIIO(output, local_u, ysize, row0, local_rows, 0, ysize,
+                                                               xsize, ysize, iterations, world);
+                    }
+                    if (local_f) std::copy(local_f, local_f + (size_t)local_rows * ysize, local_u);
+                }
+                double local_time = Clock.ElapsedTime() / 1000.0;
+                if (decomp == DECOMP_CART) local_time -= local_write;
+                double max_time;
+                MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
+                MPI_Reduce(&local_write, &write_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
+                return max_time;
+            };
+
+            double diff_mpi;
+            PhaseTimers phases;
+            resetPhaseTimers(phases);
+            TraceBuffer trace;
+            bool tracing = !trace_path.empty() && decomp == DECOMP_STRIPS;
+            if (tracing) {
+                openTrace(trace, trace_events);
+                phases.trace = &trace;
+            }
+            double max_time = runMPI(1, diff_mpi, write_binary ? binary_file.c_str() : NULL, &ckpt, &phases);
+            phase_stats[s] = reducePhaseTimers(phases, world);
+            if (tracing) {
+                std::stringstream ss_trace;
+                ss_trace << trace_path << "_size_" << grid_tag << ".json";
+                if (!writeChromeTrace(trace, ss_trace.str().c_str(), world)) {
+                    std::cerr << "Could not write " << ss_trace.str() << "\n";
+                }
+            }
+            MPI_Reduce(&ckpt.seconds, &checkpoint_times[s], 1, MPI_DOUBLE, MPI_MAX, 0, world);
+
+            // CSV is the slow path: the whole grid goes through rank 0 as text
+            double csv_time = 0.0;
+            if (write_csv && local_f) {
+                // Float strips are gathered as float rows
+                float* global_f = (rank == 0) ? new float[(size_t)xsize * ysize] : NULL;
+                MPI_Datatype float_row = rowType(ysize, MPI_FLOAT);
+                MPI_Gatherv(local_f, local_rows, float_row, global_f, &counts[0], &displs[0], float_row, 0, world);
+                MPI_Type_free(&float_row);
+                if (rank == 0) {
+                    Clock.Start();
+                    saveMatrixToCSV(global_f, xsize, ysize, size, ss_file.str() + ".csv");
+                    Clock.Stop();
+                    csv_time = Clock.ElapsedTime() / 1000.0;
+                    delete[] global_f;
+                }
+            } else if (write_csv) {
+                if (decomp == DECOMP_STRIPS) {
+                    MPI_Gatherv(local_u, local_rows, row_type,
+                                global_u, &counts[0], &displs[0], row_type, 0, world);
+                }
+                if (rank == 0) {
+                    Clock.Start();
+                    saveMatrixToCSV(global_u, xsize, ysize, size, ss_file.str() + ".csv");
+                    Clock.Stop();
+                    csv_time = Clock.ElapsedTime() / 1000.0;
+                }
+            }
+
             if (rank == 0) {
-                global_u = new double[xsize * ysize];
-                serial_u = new double[xsize * ysize];
-                initializeGrid(global_u, xsize, ysize);
-                initializeGrid(serial_u, xsize, ysize);
-                serialLaplace(serial_u, global_u, xsize, ysize, ITER);
+                mpi_times[s] = max_time;
+                std::stringstream ss_size, ss_procs;
+                ss_size << xsize << "x" << ysize;
+                ss_procs << size;
+                std::cout << std::left << std::setw(8) << "MPI" << "Size " << std::setw(9) << ss_size.str()
+                          << "Proc " << std::setw(2) << ss_procs.str()
+                          << " Diff " << std::scientific << std::setprecision(2) << diff_mpi;
+                if (distributed || precision != PRECISION_DOUBLE) {
+                    std::cout << " Max " << std::scientific << std::setprecision(2) << norms.max
+                              << " L2 " << std::scientific << std::setprecision(2) << norms.l2;
+                }
+                std::cout << " Time " << std::fixed << std::setprecision(2) << mpi_times[s] << "s";
+                if (conv.tol > 0.0) {
+                    std::cout << " Iter " << conv.iterations << " Res " << std::scientific << std::setprecision(2) << conv.residual;
+                }
+                if (write_binary) std::cout << " Bin " << std::fixed << std::setprecision(3) << write_time << "s";
+                if (write_csv) std::cout << " CSV " << std::fixed << std::setprecision(3) << csv_time << "s";
+                if (ckpt.start > 0) std::cout << " Restart@" << ckpt.start;
+                if (ckpt.every > 0) {
+                    std::cout << " Ckpt " << ckpt.written << "x " << std::fixed << std::setprecision(3) << checkpoint_times[s] << "s";
+                }
+                if (balancing) {
+                    std::cout << " Moves " << balance.migrations << " Rows ";
+                    for (int r = 0; r < size; r++) std::cout << (r > 0 ? "/" : "") << balance.rows[r];
+                }
+                std::cout << "\n";
             }
 
-            double* local_u = new double[local_rows * ysize];
-            double* local_uu = new double[local_rows * ysize];
+            // Hybrid tests: every rank runs its part with thread_counts[t] OpenMP threads
+            for (size_t t = 0; hybrid && t < thread_counts.size(); t++) {
+                double diff_hybrid;
+                max_time = runMPI(thread_counts[t], diff_hybrid, NULL, NULL, NULL);
+                if (rank == 0) {
+                    hybrid_times[t][s] = max_time;
+                    std::stringstream ss_size, ss_procs, ss_threads;
+                    ss_size << xsize << "x" << ysize;
+                    ss_procs << size;
+                    ss_threads << thread_counts[t];
+                    std::cout << std::left << std::setw(8) << "Hybrid" << "Size " << std::setw(9) << ss_size.str()
+                              << "Proc " << std::setw(2) << ss_procs.str()
+                              << " Thr " << std::setw(2) << ss_threads.str()
+                              << " Diff " << std::scientific << std::setprecision(2) << diff_hybrid
+                              << " Time " << std::fixed << std::setprecision(2) << hybrid_times[t][s] << "s";
+                    if (conv.tol > 0.0) {
+                        std::cout << " Iter " << conv.iterations << " Res " << std::scientific << std::setprecision(2) << conv.residual;
+                    }
+                    std::cout << "\n";
+                }
+            }
 
+            if (rank == 0) {
+                delete[] global_u;
+                delete[] serial_u;
+            }
+            delete[] local_ref;
+            freeAligned(local_u);
+            freeAligned(local_uu);
+            freeAligned(local_source);
+            if (local_f) {
+                freeAligned(local_f);
+                freeAligned(local_ff);
+            }
+        }
+
+        // Multigrid tests: serial solve on rank 0, then the same solve on the MPI row strips
+        if (multigrid) {
+            if (rank == 0) std::cout << "Multigrid Tests\n";
+            int rows_per_proc = xsize / size;
+            int remainder = xsize % size;
+            int local_rows = rows_per_proc + (rank < remainder ? 1 : 0);
             std::vector<int> counts(size), displs(size);
             int offset = 0;
             for (int i = 0; i < size; i++) {
                 int rows = rows_per_proc + (i < remainder ? 1 : 0);
-                counts[i] = rows * ysize;
+                counts[i] = rows;
                 displs[i] = offset;
                 offset += counts[i];
             }
-            MPI_Scatterv(global_u, &counts[0], &displs[0], MPI_DOUBLE,
-                         local_u, local_rows * ysize, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-
-            Clock.Start();
-            double diff_mpi = mpiLaplace(local_u, local_uu, local_rows, xsize, ysize, ITER, rank, size, serial_u);
-            Clock.Stop();
-            double local_time = Clock.ElapsedTime() / 1000.0;
 
+            double* global_u = NULL;
+            double* mg_u = NULL;
+            std::stringstream ss_size;
+            ss_size << xsize << "x" << ysize;
             if (rank == 0) {
-                std::stringstream ss;
-                ss << "global_u_size_" << xsize << "_procs_" << size << ".csv";
-                saveMatrixToCSV(global_u, xsize, ysize, size, ss.str());
+                global_u = new double[(size_t)xsize * ysize];
+                mg_u = new double[(size_t)xsize * ysize];
+                initializeGrid(global_u, xsize, ysize);
+                initializeGrid(mg_u, xsize, ysize);
+                double residual;
+                Clock.Start();
+                int cycles = multigridLaplace(mg_u, xsize, ysize, mg_opts, &residual);
+                Clock.Stop();
+                mg_times[s] = Clock.ElapsedTime() / 1000.0;
+                std::cout << std::left << std::setw(8) << "MG" << "Size " << std::setw(9) << ss_size.str()
+                          << "Cyc " << std::setw(3) << cycles
+                          << " Res " << std::scientific << std::setprecision(2) << residual
+                          << " Time " << std::fixed << std::setprecision(2) << mg_times[s] << "s\n";
             }
 
-            double max_time;
-            MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+            double* local_u = new double[(size_t)local_rows * ysize];
+            MPI_Scatterv(global_u, &counts[0], &displs[0], row_type,
+                         local_u, local_rows, row_type, 0, world);
+            int cycles;
+            double residual;
+            Clock.Start();
+            double diff_mg = mpiMultigrid(local_u, local_rows, xsize, ysize, rank, size, mg_u, mg_opts, &cycles, &residual, world);
+            Clock.Stop();
+            double local_time = Clock.ElapsedTime() / 1000.0, max_time;
+            MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
             if (rank == 0) {
-                mpi_times[s] = max_time;
-                std::stringstream ss_size, ss_procs;
-                ss_size << xsize << "x" << xsize;
+                mpi_mg_times[s] = max_time;
+                std::stringstream ss_procs;
                 ss_procs << size;
-                std::cout << std::left << std::setw(8) << "MPI" << "Size " << std::setw(9) << ss_size.str()
+                std::cout << std::left << std::setw(8) << "MPI-MG" << "Size " << std::setw(9) << ss_size.str()
                           << "Proc " << std::setw(2) << ss_procs.str()
-                          << " Diff " << std::scientific << std::setprecision(2) << diff_mpi
-                          << " Time " << std::fixed << std::setprecision(2) << mpi_times[s] << "s\n";
+                          << " Cyc " << std::setw(3) << cycles
+                          << " Diff " << std::scientific << std::setprecision(2) << diff_mg
+                          << " Time " << std::fixed << std::setprecision(2) << mpi_mg_times[s] << "s\n";
+                delete[] global_u;
+                delete[] mg_u;
+            }
+            delete[] local_u;
+        }
+
+        // SOR tests: serial, OpenMP and MPI red-black SOR, all run to the same tolerance
+        if (sor) {
+            double w = (omega > 0.0) ? omega : optimalOmega(xsize, ysize);
+            double sor_tol = (conv.tol > 0.0) ? conv.tol : 1e-6;
+            std::stringstream ss_size;
+            ss_size << xsize << "x" << ysize;
+            double* sor_u = NULL;
+            double* global_u = NULL;
+            if (rank == 0) {
+                std::cout << "SOR Tests (omega " << std::fixed << std::setprecision(4) << w << ")\n";
+                sor_u = new double[(size_t)xsize * ysize];
+                global_u = new double[(size_t)xsize * ysize];
+                initializeGrid(sor_u, xsize, ysize);
+                initializeGrid(global_u, xsize, ysize);
+                double residual;
+                Clock.Start();
+                sor_iters[s] = serialSOR(sor_u, xsize, ysize, w, sor_tol, ITER, &residual);
+                Clock.Stop();
+                sor_times[s] = Clock.ElapsedTime() / 1000.0;
+                std::cout << std::left << std::setw(8) << "SOR" << "Size " << std::setw(9) << ss_size.str()
+                          << "Iter " << std::setw(5) << sor_iters[s]
+                          << " Res " << std::scientific << std::setprecision(2) << residual
+                          << " Time " << std::fixed << std::setprecision(2) << sor_times[s] << "s\n";
+
+                double* u = new double[(size_t)xsize * ysize];
+                for (size_t t = 0; t < thread_counts.size(); t++) {
+                    initializeGrid(u, xsize, ysize);
+                    Clock.Start();
+                    int iters = openMPSOR(u, xsize, ysize, w, sor_tol, ITER, thread_counts[t], &residual);
+                    Clock.Stop();
+                    omp_sor_times[t][s] = Clock.ElapsedTime() / 1000.0;
+                    std::stringstream ss_threads;
+                    ss_threads << thread_counts[t];
+                    std::cout << std::left << std::setw(8) << "SOR-OMP" << "Size " << std::setw(9) << ss_size.str()
+                              << "Thr " << std::setw(2) << ss_threads.str()
+                              << " Iter " << std::setw(5) << iters
+                              << " Diff " << std::scientific << std::setprecision(2) << diffMat(u, sor_u, xsize, ysize)
+                              << " Time " << std::fixed << std::setprecision(2) << omp_sor_times[t][s] << "s\n";
+                }
+                delete[] u;
             }
 
+            int rows_per_proc = xsize / size;
+            int remainder = xsize % size;
+            int local_rows = rows_per_proc + (rank < remainder ? 1 : 0);
+            std::vector<int> counts(size), displs(size);
+            int offset = 0;
+            for (int i = 0; i < size; i++) {
+                int rows = rows_per_proc + (i < remainder ? 1 : 0);
+                counts[i] = rows;
+                displs[i] = offset;
+                offset += counts[i];
+            }
+            double* local_u = new double[(size_t)local_rows * ysize];
+            MPI_Scatterv(global_u, &counts[0], &displs[0], row_type,
+                         local_u, local_rows, row_type, 0, world);
+            int iters;
+            double residual;
+            Clock.Start();
+            double diff_sor = mpiSOR(local_u, local_rows, xsize, ysize, rank, size, w, sor_tol, ITER, sor_u, &iters, &residual, world);
+            Clock.Stop();
+            double local_time = Clock.ElapsedTime() / 1000.0, max_time;
+            MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
             if (rank == 0) {
+                mpi_sor_times[s] = max_time;
+                std::stringstream ss_procs;
+                ss_procs << size;
+                std::cout << std::left << std::setw(8) << "SOR-MPI" << "Size " << std::setw(9) << ss_size.str()
+                          << "Proc " << std::setw(2) << ss_procs.str()
+                          << " Iter " << std::setw(5) << iters
+                          << " Diff " << std::scientific << std::setprecision(2) << diff_sor
+                          << " Time " << std::fixed << std::setprecision(2) << mpi_sor_times[s] << "s\n";
+                delete[] sor_u;
                 delete[] global_u;
-                delete[] serial_u;
             }
             delete[] local_u;
-            delete[] local_uu;
         }
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Type_free(&row_type);
+        delete[] problem_source;
+        delete[] problem_values;
+        MPI_Barrier(world);
         if (rank == 0) std::cout << "\n";
     }
 
+    // 3D tests: serial 7-point Jacobi on rank 0, then the same sweeps on a 3D process grid. The 3D solver
+    // exchanges its faces one dimension at a time (blocking) or all at once around the interior sweep
+    Laplace3DOptions opts_3d = {tile_3d, halo_mode != HALO_BLOCKING, halo_mode == HALO_PERSISTENT};
+    if (!sizes_3d.empty() && rank == 0) {
+        bool fallback = halo_mode == HALO_SHARED || halo_mode == HALO_RMA || halo_mode == HALO_RMA_FENCE;
+        if (fallback) {
+            std::cerr << haloModeName(halo_mode) << " halos need the strips decomposition, 3D falls back to nonblocking\n";
+        }
+        std::cout << "3D Tests (" << iter_3d << " sweeps, " << (opts_3d.persistent ? "persistent" : opts_3d.overlap
+                  ? "nonblocking" : "blocking") << " face exchange";
+        if (fallback) std::cout << ", falling back from " << haloModeName(halo_mode) << " halos";
+        std::cout << ")\n";
+    }
+    for (size_t s = 0; s < sizes_3d.size(); s++) {
+        int nx = sizes_3d[s], ny = widths_3d[s], nz = depths_3d[s];
+        size_t count = (size_t)nx * ny * nz;
+        std::stringstream ss_size;
+        ss_size << nx << "x" << ny << "x" << nz;
+        double* serial_u = NULL;
+        if (rank == 0) {
+            serial_u = allocAligned(count);
+            double* scratch = allocAligned(count);
+            initializeBlock3D(serial_u, ny, nz, 0, nx, ny, nz, nx);
+            Clock.Start();
+            serialLaplace3D(serial_u, scratch, nx, ny, nz, iter_3d);
+            Clock.Stop();
+            freeAligned(scratch);
+            std::cout << std::left << std::setw(10) << "Serial3D" << "Size " << std::setw(13) << ss_size.str()
+                      << "Time " << std::fixed << std::setprecision(2) << Clock.ElapsedTime() / 1000.0 << "s\n";
+        }
+
+        std::stringstream ss_file;
+        ss_file << "global_u3d_size_" << ss_size.str() << "_procs_" << size << ".bin";
+        PhaseTimers phases;
+        resetPhaseTimers(phases);
+        double local_write = 0.0, write_time, max_time;
+        Clock.Start();
+        double diff = mpiLaplace3D(nx, ny, nz, iter_3d, rank, size, serial_u, opts_3d, 1,
+                                   write_binary ? ss_file.str().c_str() : NULL, &local_write, &phases, world, reorder);
+        Clock.Stop();
+        double local_time = Clock.ElapsedTime() / 1000.0 - local_write;
+        MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
+        MPI_Reduce(&local_write, &write_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
+        PhaseStats stats_3d = reducePhaseTimers(phases, world);
+        if (rank == 0) {
+            std::stringstream ss_procs;
+            ss_procs << size;
+            std::cout << std::left << std::setw(10) << "MPI3D" << "Size " << std::setw(13) << ss_size.str()
+                      << "Proc " << std::setw(2) << ss_procs.str()
+                      << " Diff " << std::scientific << std::setprecision(2) << diff
+                      << " Time " << std::fixed << std::setprecision(2) << max_time << "s";
+            if (write_binary) std::cout << " Bin " << std::fixed << std::setprecision(3) << write_time << "s";
+            std::cout << "\n";
+        }
+
+        // Hybrid tests: every rank sweeps its block with thread_counts[t] OpenMP threads
+        for (size_t t = 0; hybrid && t < thread_counts.size(); t++) {
+            Clock.Start();
+            double diff_hybrid = mpiLaplace3D(nx, ny, nz, iter_3d, rank, size, serial_u, opts_3d, thread_counts[t],
+                                              NULL, NULL, NULL, world, reorder);
+            Clock.Stop();
+            local_time = Clock.ElapsedTime() / 1000.0;
+            MPI_Reduce(&local_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, world);
+            if (rank == 0) {
+                std::stringstream ss_procs, ss_threads;
+                ss_procs << size;
+                ss_threads << thread_counts[t];
+                std::cout << std::left << std::setw(10) << "Hybrid3D" << "Size " << std::setw(13) << ss_size.str()
+                          << "Proc " << std::setw(2) << ss_procs.str()
+                          << " Thr " << std::setw(2) << ss_threads.str()
+                          << " Diff " << std::scientific << std::setprecision(2) << diff_hybrid
+                          << " Time " << std::fixed << std::setprecision(2) << max_time << "s\n";
+            }
+        }
+        if (rank == 0) {
+            std::cout << "\nMPI3D phases, " << ss_size.str() << " on " << size << " process(es):\n";
+            printPhaseStats(stats_3d);
+            std::cout << "\n";
+            freeAligned(serial_u);
+        }
+    }
+
     // Performance table
     if (rank == 0) {
+        std::string rule = "+-----+";
+        for (size_t s = 0; s < sizes.size(); s++) rule += "-------+";
+        rule += "\n";
         std::cout << "+-----------------------------------------+\n";
         std::cout << "| Performance Table (Times in Seconds)    |\n";
-        std::cout << "+-----+-------+-------+-------+-------+-------+\n";
-        std::cout << "| Conf| 64x64 |128x128|256x256|512x512|1024x1024|\n";
-        std::cout << "+-----+-------+-------+-------+-------+-------+\n";
+        std::cout << rule;
+        std::cout << "| Conf|";
+        for (size_t s = 0; s < sizes.size(); s++) {
+            std::stringstream ss;
+            ss << sizes[s] << "x" << widths[s];
+            std::cout << std::setw(7) << ss.str() << "|";
+        }
+        std::cout << "\n" << rule;
 
         // Serial
         std::cout << "| Ser |";
         for (size_t s = 0; s < sizes.size(); s++) {
             std::cout << std::fixed << std::setprecision(2) << std::setw(6) << serial_times[s] << " |";
         }
-        std::cout << "\n+-----+-------+-------+-------+-------+-------+\n";
+        std::cout << "\n" << rule;
 
         // OpenMP
         for (size_t t = 0; t < thread_counts.size(); t++) {
@@ -433,7 +2585,19 @@ int main(int argc, char* argv[]) {
             }
             std::cout << "\n";
         }
-        std::cout << "+-----+-------+-------+-------+-------+-------+\n";
+        std::cout << rule;
+
+        // Tiled OpenMP
+        for (size_t t = 0; tiled && t < thread_counts.size(); t++) {
+            std::stringstream ss;
+            ss << thread_counts[t];
+            std::cout << "| TIL" << std::setw(2) << ss.str() << "|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << tiled_times[t][s] << " |";
+            }
+            std::cout << "\n";
+        }
+        if (tiled) std::cout << rule;
 
         // MPI
         if (size >= 1 && size <= 16) {
@@ -445,9 +2609,81 @@ int main(int argc, char* argv[]) {
             }
             std::cout << "\n";
         }
-        std::cout << "+-----+-------+-------+-------+-------+-------+\n";
+
+        // Checkpoint cost, already included in the MPI times above
+        if (!checkpoint_path.empty()) {
+            std::cout << "| Ckpt|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << checkpoint_times[s] << " |";
+            }
+            std::cout << "\n";
+        }
+
+        // Hybrid, one row per ranks x threads combination
+        for (size_t t = 0; hybrid && t < thread_counts.size(); t++) {
+            std::stringstream ss;
+            ss << size << "x" << thread_counts[t];
+            std::cout << "| H" << std::setw(4) << ss.str() << "|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << hybrid_times[t][s] << " |";
+            }
+            std::cout << "\n";
+        }
+
+        // Multigrid
+        if (multigrid) {
+            std::stringstream ss;
+            ss << size;
+            std::cout << "| MG  |";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << mg_times[s] << " |";
+            }
+            std::cout << "\n| MGP" << std::setw(2) << ss.str() << "|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << mpi_mg_times[s] << " |";
+            }
+            std::cout << "\n";
+        }
+
+        // SOR: serial (SOR), OpenMP threads (SOT<t>), MPI processes (SOP<p>) and sweeps to tolerance
+        if (sor) {
+            std::cout << rule;
+            std::cout << "| SOR |";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << sor_times[s] << " |";
+            }
+            std::cout << "\n";
+            for (size_t t = 0; t < thread_counts.size(); t++) {
+                std::stringstream ss;
+                ss << thread_counts[t];
+                std::cout << "| SOT" << std::setw(2) << ss.str() << "|";
+                for (size_t s = 0; s < sizes.size(); s++) {
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(6) << omp_sor_times[t][s] << " |";
+                }
+                std::cout << "\n";
+            }
+            std::stringstream ss;
+            ss << size;
+            std::cout << "| SOP" << std::setw(2) << ss.str() << "|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::fixed << std::setprecision(2) << std::setw(6) << mpi_sor_times[s] << " |";
+            }
+            std::cout << "\n| Iter|";
+            for (size_t s = 0; s < sizes.size(); s++) {
+                std::cout << std::setw(6) << sor_iters[s] << " |";
+            }
+            std::cout << "\n";
+        }
+        std::cout << rule;
+
+        // Where the strips solver spent its time, and how evenly across the ranks
+        for (size_t s = 0; decomp == DECOMP_STRIPS && size <= 16 && s < sizes.size(); s++) {
+            std::cout << "\nMPI phases, " << sizes[s] << "x" << widths[s] << " on " << size << " process(es):\n";
+            printPhaseStats(phase_stats[s]);
+        }
     }
 
+    MPI_Comm_free(&world);
     MPI_Finalize();
     return 0;
 }
@@ -0,0 +1,377 @@
+// Including Packages
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <mpi.h>
+#include "Laplace.h"
+#include "Multigrid.h"
+
+// Coarsening stops once either side of a level has this many points or fewer
+#define MG_MIN_SIZE 5
+// Red-black sweeps used as the coarsest-grid solve
+#define MG_COARSE_SWEEPS 50
+
+// Each level solves L u = f with L u = 4u - (sum of the four neighbours), i.e. the 5-point
+// Laplacian scaled by h^2. Coarse point c sits on fine point min(2c, n-1), so grids whose
+// size is not 2^k+1 end with one short interval next to the last boundary. Every level keeps
+// the positions of its points, and the operator and transfers are weighted by the actual
+// spacing there; on uniform levels all the weights are exactly 1 (or 1/2 for interpolation).
+
+// One level of the hierarchy. Each rank holds global rows [row0, row0 + rows) of an nx x ny
+// grid plus a ghost row above and below; gathered levels hold every row on rank 0.
+struct MGLevel {
+    int nx, ny;
+    int row0, rows;
+    int up, down;
+    std::vector<double> u, f, r;
+    // Per row (x) and column (y), in units of this level's spacing: the operator's weights of the
+    // lower and upper neighbour, the half width of the point's cell, and for points between two
+    // coarse points the interpolation weight of the upper one
+    std::vector<double> wxm, wxp, sx, ax;
+    std::vector<double> wym, wyp, sy, ay;
+};
+
+struct MGHierarchy {
+    std::vector<MGLevel> levels;
+    int gathered;                    // First level held entirely on rank 0 (levels.size() if none)
+    std::vector<int> gather_counts;  // Gatherv layout of that level's rows, in doubles
+    std::vector<int> gather_displs;
+    MPI_Comm comm;
+    int rank, size;
+};
+
+const char* mgCycleName(MGCycle cycle) {
+    return cycle == MG_FCYCLE ? "F-cycle" : "V-cycle";
+}
+
+static inline size_t at(const MGLevel& L, int x, int y) {
+    return (size_t)(x - L.row0 + 1) * L.ny + y;
+}
+
+static int coarseSize(int n) {
+    return n / 2 + 1;
+}
+
+// Coarse rows [ca, cb) whose fine points lie in the fine rows [a, b)
+static void coarseRange(int n, int a, int b, int& ca, int& cb) {
+    ca = (a + 1) / 2;
+    cb = (b == n) ? coarseSize(n) : (b + 1) / 2;
+}
+
+static void allocateLevel(MGLevel& L) {
+    L.u.assign((size_t)(L.rows + 2) * L.ny, 0.0);
+    L.f.assign((size_t)(L.rows + 2) * L.ny, 0.0);
+    L.r.assign((size_t)(L.rows + 2) * L.ny, 0.0);
+}
+
+// Weights of one direction from the point positions p (in fine grid spacings) of a level whose
+// regular spacing is h: the second difference with neighbours hl and hr away is
+// 2 / (hl + hr) * ((u+ - u) / hr - (u - u-) / hl)
+static void setSpacing(const std::vector<double>& p, double h, std::vector<double>& wm, std::vector<double>& wp,
+                       std::vector<double>& half, std::vector<double>& a) {
+    int n = p.size();
+    wm.assign(n, 0.0);
+    wp.assign(n, 0.0);
+    half.assign(n, 1.0);
+    a.assign(n, 0.0);
+    for (int i = 1; i < n - 1; i++) {
+        double hl = (p[i] - p[i - 1]) / h;
+        double hr = (p[i + 1] - p[i]) / h;
+        wm[i] = 2.0 / (hl * (hl + hr));
+        wp[i] = 2.0 / (hr * (hl + hr));
+        half[i] = 0.5 * (hl + hr);
+        a[i] = hl / (hl + hr);
+    }
+}
+
+// Positions of the coarse points of a level with positions p
+static std::vector<double> coarsePositions(const std::vector<double>& p) {
+    int n = p.size();
+    std::vector<double> pc(coarseSize(n));
+    for (int c = 0; c < (int)pc.size(); c++) pc[c] = p[std::min(2 * c, n - 1)];
+    return pc;
+}
+
+// Build every level below the fine one. Levels stay distributed while each rank keeps at
+// least two rows; from the first level that would not, rank 0 holds the whole level and
+// the other ranks keep only that level as a receive buffer for its correction.
+static void buildHierarchy(MGHierarchy& H, int nx, int ny, int row0, int rows, MPI_Comm comm) {
+    H.comm = comm;
+    MPI_Comm_rank(comm, &H.rank);
+    MPI_Comm_size(comm, &H.size);
+
+    std::vector<int> starts(H.size), ends(H.size);
+    MPI_Allgather(&row0, 1, MPI_INT, &starts[0], 1, MPI_INT, comm);
+    for (int r = 0; r < H.size; r++) ends[r] = starts[r];
+    std::vector<int> all_rows(H.size);
+    MPI_Allgather(&rows, 1, MPI_INT, &all_rows[0], 1, MPI_INT, comm);
+    for (int r = 0; r < H.size; r++) ends[r] += all_rows[r];
+
+    H.levels.clear();
+    H.gathered = -1;
+    int lnx = nx, lny = ny;
+    std::vector<double> px(nx), py(ny);
+    for (int x = 0; x < nx; x++) px[x] = x;
+    for (int y = 0; y < ny; y++) py[y] = y;
+    double spacing = 1.0;
+    while (true) {
+        int level = H.levels.size();
+        MGLevel L;
+        L.nx = lnx;
+        L.ny = lny;
+        if (H.gathered < 0) {
+            L.row0 = starts[H.rank];
+            L.rows = ends[H.rank] - starts[H.rank];
+            L.up = (H.rank == 0) ? MPI_PROC_NULL : H.rank - 1;
+            L.down = (H.rank == H.size - 1) ? MPI_PROC_NULL : H.rank + 1;
+        } else {
+            L.row0 = 0;
+            L.rows = lnx;
+            L.up = L.down = MPI_PROC_NULL;
+        }
+        allocateLevel(L);
+        setSpacing(px, spacing, L.wxm, L.wxp, L.sx, L.ax);
+        setSpacing(py, spacing, L.wym, L.wyp, L.sy, L.ay);
+        H.levels.push_back(L);
+
+        if (lnx <= MG_MIN_SIZE || lny <= MG_MIN_SIZE) break;
+        if (level == H.gathered && H.rank != 0) break;
+
+        if (H.gathered < 0) {
+            bool thin = false;
+            for (int r = 0; r < H.size; r++) {
+                coarseRange(lnx, starts[r], ends[r], starts[r], ends[r]);
+                if (ends[r] - starts[r] < 2) thin = true;
+            }
+            if (thin) {
+                H.gathered = level + 1;
+                H.gather_counts.resize(H.size);
+                H.gather_displs.resize(H.size);
+                for (int r = 0; r < H.size; r++) {
+                    H.gather_counts[r] = (ends[r] - starts[r]) * coarseSize(lny);
+                    H.gather_displs[r] = (starts[r] + 1) * coarseSize(lny);
+                }
+            }
+        }
+        lnx = coarseSize(lnx);
+        lny = coarseSize(lny);
+        px = coarsePositions(px);
+        py = coarsePositions(py);
+        spacing *= 2.0;
+    }
+    if (H.gathered < 0) H.gathered = H.levels.size();
+}
+
+static void exchangeHalos(MGLevel& L, std::vector<double>& v, MPI_Comm comm) {
+    if (L.up == MPI_PROC_NULL && L.down == MPI_PROC_NULL) return;
+    MPI_Sendrecv(&v[at(L, L.row0 + L.rows - 1, 0)], L.ny, MPI_DOUBLE, L.down, 0,
+                 &v[at(L, L.row0 - 1, 0)], L.ny, MPI_DOUBLE, L.up, 0, comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&v[at(L, L.row0, 0)], L.ny, MPI_DOUBLE, L.up, 1,
+                 &v[at(L, L.row0 + L.rows, 0)], L.ny, MPI_DOUBLE, L.down, 1, comm, MPI_STATUS_IGNORE);
+}
+
+// Red-black Gauss-Seidel; the colour of a point is the parity of its global x + y
+static void smooth(MGLevel& L, int sweeps, MPI_Comm comm) {
+    int xa = std::max(L.row0, 1);
+    int xb = std::min(L.row0 + L.rows, L.nx - 1);
+    for (int s = 0; s < sweeps; s++) {
+        for (int colour = 0; colour < 2; colour++) {
+            exchangeHalos(L, L.u, comm);
+            for (int x = xa; x < xb; x++) {
+                for (int y = 1 + (x + 1 + colour) % 2; y < L.ny - 1; y += 2) {
+                    double diag = L.wxm[x] + L.wxp[x] + L.wym[y] + L.wyp[y];
+                    L.u[at(L, x, y)] = (L.f[at(L, x, y)] + L.wxm[x] * L.u[at(L, x-1, y)] + L.wxp[x] * L.u[at(L, x+1, y)] +
+                                        L.wym[y] * L.u[at(L, x, y-1)] + L.wyp[y] * L.u[at(L, x, y+1)]) / diag;
+                }
+            }
+        }
+    }
+}
+
+// r = f - L u on the owned interior points; returns the local max |r|
+static double residual(MGLevel& L, MPI_Comm comm) {
+    exchangeHalos(L, L.u, comm);
+    int xa = std::max(L.row0, 1);
+    int xb = std::min(L.row0 + L.rows, L.nx - 1);
+    double norm = 0.0;
+    for (int x = xa; x < xb; x++) {
+        for (int y = 1; y < L.ny - 1; y++) {
+            double diag = L.wxm[x] + L.wxp[x] + L.wym[y] + L.wyp[y];
+            double r = L.f[at(L, x, y)] - (diag * L.u[at(L, x, y)] - L.wxm[x] * L.u[at(L, x-1, y)] -
+                                           L.wxp[x] * L.u[at(L, x+1, y)] - L.wym[y] * L.u[at(L, x, y-1)] -
+                                           L.wyp[y] * L.u[at(L, x, y+1)]);
+            L.r[at(L, x, y)] = r;
+            norm = std::max(norm, std::abs(r));
+        }
+    }
+    return norm;
+}
+
+// Full-weighting restriction of level l's residual into the right-hand side of level l+1,
+// whose correction starts from zero. The weights are those of prolongCorrection, and the sum is
+// divided by the coarse cell's area, which is 1 except next to a short interval
+static void restrictResidual(MGHierarchy& H, int l) {
+    MGLevel& L = H.levels[l];
+    MGLevel& C = H.levels[l + 1];
+    MPI_Comm comm = (l < H.gathered) ? H.comm : MPI_COMM_SELF;
+    exchangeHalos(L, L.r, comm);
+
+    int ca, cb;
+    coarseRange(L.nx, L.row0, L.row0 + L.rows, ca, cb);
+    bool gather = (l + 1 == H.gathered && H.size > 1);
+    std::vector<double> rows_out;
+    if (gather) rows_out.assign((cb - ca) * C.ny, 0.0);
+
+    for (int c = ca; c < cb; c++) {
+        double* out = gather ? &rows_out[(c - ca) * C.ny] : &C.f[at(C, c, 0)];
+        for (int d = 0; d < C.ny; d++) out[d] = 0.0;
+        if (c == 0 || c == C.nx - 1) continue;
+        int x = 2 * c;
+        // Weights of fine rows x-1, x and x+1; coarse point c is the upper neighbour of row x-1
+        double wx[3] = {L.ax[x - 1], 1.0, 1.0 - L.ax[x + 1]};
+        for (int d = 1; d < C.ny - 1; d++) {
+            int y = 2 * d;
+            double wy[3] = {L.ay[y - 1], 1.0, 1.0 - L.ay[y + 1]};
+            double sum = 0.0;
+            for (int i = 0; i < 3; i++) {
+                const double* row = &L.r[at(L, x - 1 + i, y - 1)];
+                sum += wx[i] * (wy[0] * row[0] + wy[1] * row[1] + wy[2] * row[2]);
+            }
+            // 1/16 weights, times 4 for the doubled mesh width in the h^2-scaled operator
+            out[d] = sum / (C.sx[c] * C.sy[d]);
+        }
+    }
+    if (gather) {
+        MPI_Gatherv(rows_out.empty() ? NULL : &rows_out[0], (cb - ca) * C.ny, MPI_DOUBLE,
+                    H.rank == 0 ? &C.f[0] : NULL, &H.gather_counts[0], &H.gather_displs[0], MPI_DOUBLE, 0, H.comm);
+    }
+    std::fill(C.u.begin(), C.u.end(), 0.0);
+}
+
+// Bilinear interpolation of level l+1's correction, added to level l. A fine point between two
+// coarse points is weighted by its distance to them, which is only uneven next to a short interval
+static void prolongCorrection(MGHierarchy& H, int l) {
+    MGLevel& L = H.levels[l];
+    MGLevel& C = H.levels[l + 1];
+    if (l + 1 < H.gathered) exchangeHalos(C, C.u, H.comm);
+
+    int xa = std::max(L.row0, 1);
+    int xb = std::min(L.row0 + L.rows, L.nx - 1);
+    for (int x = xa; x < xb; x++) {
+        int cx = x / 2;
+        bool odd_x = x % 2;
+        double a = L.ax[x];
+        for (int y = 1; y < L.ny - 1; y++) {
+            int cy = y / 2;
+            double b = L.ay[y];
+            double e = C.u[at(C, cx, cy)];
+            if (odd_x && y % 2) {
+                e = (1.0 - a) * ((1.0 - b) * e + b * C.u[at(C, cx, cy + 1)]) +
+                    a * ((1.0 - b) * C.u[at(C, cx + 1, cy)] + b * C.u[at(C, cx + 1, cy + 1)]);
+            } else if (odd_x) {
+                e = (1.0 - a) * e + a * C.u[at(C, cx + 1, cy)];
+            } else if (y % 2) {
+                e = (1.0 - b) * e + b * C.u[at(C, cx, cy + 1)];
+            }
+            L.u[at(L, x, y)] += e;
+        }
+    }
+}
+
+static void cycle(MGHierarchy& H, int l, MGCycle type, const MultigridOptions& opts) {
+    MGLevel& L = H.levels[l];
+    MPI_Comm comm = (l < H.gathered) ? H.comm : MPI_COMM_SELF;
+    if (l == (int)H.levels.size() - 1) {
+        smooth(L, MG_COARSE_SWEEPS, comm);
+        return;
+    }
+
+    smooth(L, opts.pre_smooth, comm);
+    residual(L, comm);
+    restrictResidual(H, l);
+    if (l + 1 != H.gathered || H.rank == 0) {
+        cycle(H, l + 1, type, opts);
+        if (type == MG_FCYCLE) cycle(H, l + 1, MG_VCYCLE, opts);
+    }
+    if (l + 1 == H.gathered && H.size > 1) {
+        MGLevel& C = H.levels[l + 1];
+        MPI_Bcast(&C.u[0], C.u.size(), MPI_DOUBLE, 0, H.comm);
+    }
+    prolongCorrection(H, l);
+    smooth(L, opts.post_smooth, comm);
+}
+
+// Run cycles on the fine level until the global max residual drops below opts.tol
+static int solveHierarchy(MGHierarchy& H, const MultigridOptions& opts, double* residual_out) {
+    MGLevel& L = H.levels[0];
+    double local_norm = residual(L, H.comm), norm;
+    MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_MAX, H.comm);
+    int cycles = 0;
+    while (cycles < opts.max_cycles && norm >= opts.tol) {
+        cycle(H, 0, opts.cycle, opts);
+        cycles++;
+        local_norm = residual(L, H.comm);
+        MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_MAX, H.comm);
+    }
+    if (residual_out) *residual_out = norm;
+    return cycles;
+}
+
+int multigridLaplace(double* u, int xsize, int ysize, const MultigridOptions& opts, double* residual) {
+    MGHierarchy H;
+    buildHierarchy(H, xsize, ysize, 0, xsize, MPI_COMM_SELF);
+    MGLevel& L = H.levels[0];
+    std::copy(u, u + (size_t)xsize * ysize, &L.u[at(L, 0, 0)]);
+    int cycles = solveHierarchy(H, opts, residual);
+    std::copy(&L.u[at(L, 0, 0)], &L.u[at(L, 0, 0)] + (size_t)xsize * ysize, u);
+    return cycles;
+}
+
+double mpiMultigrid(double* local_u, int local_rows, int global_xsize, int ysize, int rank, int size,
+                    double* reference, const MultigridOptions& opts, int* cycles, double* residual, MPI_Comm comm) {
+    // Rows per rank and first global row of each rank
+    std::vector<int> counts(size), displs(size);
+    size_t local_count = (size_t)local_rows * ysize;
+    MPI_Allgather(&local_rows, 1, MPI_INT, &counts[0], 1, MPI_INT, comm);
+    int offset = 0;
+    for (int i = 0; i < size; i++) {
+        displs[i] = offset;
+        offset += counts[i];
+    }
+    int min_rows;
+    MPI_Allreduce(&local_rows, &min_rows, 1, MPI_INT, MPI_MIN, comm);
+
+    double* global_u = NULL;
+    if (rank == 0) global_u = new double[(size_t)global_xsize * ysize];
+    MPI_Datatype row_type = rowType(ysize);
+
+    double res = 0.0;
+    int n_cycles = 0;
+    if (min_rows < 2) {
+        // Strips too thin to distribute the fine level: solve the whole grid on rank 0
+        MPI_Gatherv(local_u, local_rows, row_type, global_u, &counts[0], &displs[0], row_type, 0, comm);
+        if (rank == 0) n_cycles = multigridLaplace(global_u, global_xsize, ysize, opts, &res);
+        MPI_Bcast(&n_cycles, 1, MPI_INT, 0, comm);
+        MPI_Bcast(&res, 1, MPI_DOUBLE, 0, comm);
+    } else {
+        int row0 = displs[rank];
+        MGHierarchy H;
+        buildHierarchy(H, global_xsize, ysize, row0, local_rows, comm);
+        MGLevel& L = H.levels[0];
+        std::copy(local_u, local_u + local_count, &L.u[at(L, row0, 0)]);
+        n_cycles = solveHierarchy(H, opts, &res);
+        std::copy(&L.u[at(L, row0, 0)], &L.u[at(L, row0, 0)] + local_count, local_u);
+        MPI_Gatherv(local_u, local_rows, row_type, global_u, &counts[0], &displs[0], row_type, 0, comm);
+    }
+    MPI_Type_free(&row_type);
+    if (cycles) *cycles = n_cycles;
+    if (residual) *residual = res;
+
+    double diff = 0.0;
+    if (rank == 0) {
+        diff = diffMat(global_u, reference, global_xsize, ysize);
+        delete[] global_u;
+    }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, comm);
+    return diff;
+}
@@ -0,0 +1,33 @@
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+#include <mpi.h>
+
+// Multigrid cycle shapes
+enum MGCycle {
+    MG_VCYCLE,
+    MG_FCYCLE
+};
+
+struct MultigridOptions {
+    MGCycle cycle;
+    int pre_smooth;   // Red-black Gauss-Seidel sweeps before the coarse-grid correction
+    int post_smooth;  // and after it
+    double tol;       // Stop once the max residual is below tol
+    int max_cycles;
+};
+
+const char* mgCycleName(MGCycle cycle);
+
+// Serial geometric multigrid, solves u in place starting from the boundary values set by
+// initializeGrid. Returns the number of cycles run, the final max residual goes to *residual.
+int multigridLaplace(double* u, int xsize, int ysize, const MultigridOptions& opts, double* residual);
+
+// Distributed multigrid on the same row strips as mpiLaplace. Coarse levels that would leave a
+// rank with fewer than two rows are gathered onto rank 0 and solved there. Returns the
+// difference to reference (only read on rank 0), the cycle count goes to *cycles; rank and size are within comm.
+double mpiMultigrid(double* local_u, int local_rows, int global_xsize, int ysize, int rank, int size,
+                    double* reference, const MultigridOptions& opts, int* cycles, double* residual,
+                    MPI_Comm comm = MPI_COMM_WORLD);
+
+#endif
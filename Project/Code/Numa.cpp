@@ -0,0 +1,141 @@
+// Including Packages
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+#include <omp.h>
+#include "Numa.h"
+#include "Simd.h"
+
+// Parse a kernel CPU list such as "0-3,8,10-11"
+static std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int first, last;
+        char dash;
+        std::stringstream range(item);
+        if (!(range >> first)) continue;
+        if (!(range >> dash >> last)) last = first;
+        for (int c = first; c <= last; c++) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int> > numaNodeCpus() {
+    std::vector<std::vector<int> > nodes;
+    for (int n = 0; n < 1024; n++) {
+        std::stringstream path;
+        path << "/sys/devices/system/node/node" << n << "/cpulist";
+        std::ifstream file(path.str().c_str());
+        std::string list;
+        if (!file || !std::getline(file, list)) continue;
+        std::vector<int> cpus = parseCpuList(list);
+        if (!cpus.empty()) nodes.push_back(cpus); // Memory-only nodes have no CPUs to pin to
+    }
+    if (nodes.empty()) {
+        std::vector<int> all;
+        for (int c = 0; c < omp_get_num_procs(); c++) all.push_back(c);
+        nodes.push_back(all);
+    }
+    return nodes;
+}
+
+#ifdef __linux__
+// Pin the calling thread to one CPU
+static void pinTo(int cpu) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    sched_setaffinity(0, sizeof(mask), &mask);
+}
+
+// Best seconds of reps triads a = b + s * c over n elements on threads pinned to cpus. With touch
+// set the arrays are first written there, which places their pages on that node.
+static double pinnedTriad(double* a, double* b, double* c, size_t n, const std::vector<int>& cpus,
+                          int reps, bool touch) {
+    double best = 1e300;
+    int threads = (int)cpus.size();
+    #pragma omp parallel num_threads(threads)
+    {
+        cpu_set_t saved;
+        sched_getaffinity(0, sizeof(saved), &saved);
+        pinTo(cpus[omp_get_thread_num() % cpus.size()]);
+        if (touch) {
+            #pragma omp for schedule(static)
+            for (long i = 0; i < (long)n; i++) {
+                a[i] = 0.0;
+                b[i] = 1.0;
+                c[i] = 2.0;
+            }
+        }
+        for (int r = 0; r < reps; r++) {
+            double start = 0.0;
+            #pragma omp barrier
+            #pragma omp master
+            start = omp_get_wtime();
+            #pragma omp for schedule(static)
+            for (long i = 0; i < (long)n; i++) {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+            #pragma omp master
+            best = std::min(best, omp_get_wtime() - start);
+        }
+        sched_setaffinity(0, sizeof(saved), &saved);
+    }
+    return best;
+}
+
+void runNumaBenchmark(size_t megabytes, int reps) {
+    std::vector<std::vector<int> > nodes = numaNodeCpus();
+    size_t n = std::max(megabytes, (size_t)1) * (1 << 20) / sizeof(double);
+    int count = (int)nodes.size();
+
+    std::cout << "NUMA triad bandwidth (GB/s, 24 bytes per element), " << megabytes << " MiB arrays, best of "
+              << reps << ", " << (hugePagesEnabled() ? "2 MiB" : "4 KiB") << " pages\n";
+    if (count == 1) std::cout << "Only one NUMA node, so there is no remote memory to compare with\n";
+    std::cout << std::left << std::setw(12) << "Data\\CPUs";
+    for (int r = 0; r < count; r++) {
+        std::stringstream name;
+        name << "node " << r << " (" << nodes[r].size() << ")";
+        std::cout << std::right << std::setw(16) << name.str();
+    }
+    std::cout << "\n";
+
+    for (int d = 0; d < count; d++) {
+        std::stringstream name;
+        name << "node " << d;
+        std::cout << std::left << std::setw(12) << name.str();
+        for (int r = 0; r < count; r++) {
+            // Fresh arrays for every pair, so their pages are placed by this pair's first touch
+            double* a = allocAligned(n);
+            double* b = allocAligned(n);
+            double* c = allocAligned(n);
+            pinnedTriad(a, b, c, n, nodes[d], 0, true);
+            double seconds = pinnedTriad(a, b, c, n, nodes[r], reps, false);
+            std::cout << std::right << std::fixed << std::setprecision(2) << std::setw(16)
+                      << 24.0 * n / seconds / 1e9;
+            freeAligned(a);
+            freeAligned(b);
+            freeAligned(c);
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+#else
+// Pinning threads to a node's CPUs uses Linux affinity masks
+void runNumaBenchmark(size_t megabytes, int reps) {
+    (void)megabytes;
+    (void)reps;
+    std::cout << "The NUMA benchmark needs Linux, skipped\n\n";
+}
+#endif
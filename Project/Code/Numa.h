@@ -0,0 +1,16 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+#include <vector>
+
+// CPUs of every NUMA node (from /sys/devices/system/node), one entry holding all online CPUs
+// when the machine has no NUMA information
+std::vector<std::vector<int> > numaNodeCpus();
+
+// Local vs remote memory bandwidth: for every pair of nodes the arrays (megabytes each) are first
+// touched by threads pinned to the data node, then a triad runs reps times on threads pinned to
+// the compute node. Prints a table of the best GB/s with data nodes as rows (Linux only).
+void runNumaBenchmark(size_t megabytes, int reps);
+
+#endif
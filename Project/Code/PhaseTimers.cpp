@@ -0,0 +1,49 @@
+// Including Packages
+#include <iostream>
+#include <iomanip>
+#include <mpi.h>
+#include "PhaseTimers.h"
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+        case PHASE_COPY: return "copy";
+        case PHASE_HALO_POST: return "halo post";
+        case PHASE_HALO_WAIT: return "halo wait";
+        case PHASE_INTERIOR: return "interior";
+        case PHASE_EDGE: return "edge";
+        case PHASE_CHECK: return "check";
+        case PHASE_MIGRATE: return "migrate";
+        case PHASE_GATHER: return "gather";
+        case PHASE_VERIFY: return "verify";
+        default: return "?";
+    }
+}
+
+void resetPhaseTimers(PhaseTimers& timers) {
+    for (int p = 0; p < PHASE_COUNT; p++) timers.seconds[p] = 0.0;
+    timers.mark = 0.0;
+    timers.iteration = 0;
+    timers.trace = NULL;
+}
+
+PhaseStats reducePhaseTimers(const PhaseTimers& timers, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    PhaseStats stats;
+    MPI_Reduce(timers.seconds, stats.min, PHASE_COUNT, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(timers.seconds, stats.max, PHASE_COUNT, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(timers.seconds, stats.avg, PHASE_COUNT, MPI_DOUBLE, MPI_SUM, 0, comm);
+    for (int p = 0; p < PHASE_COUNT; p++) stats.avg[p] /= size;
+    return stats;
+}
+
+void printPhaseStats(const PhaseStats& stats) {
+    std::cout << std::left << std::setw(11) << "Phase" << std::right << std::setw(10) << "Min(s)"
+              << std::setw(10) << "Avg(s)" << std::setw(10) << "Max(s)" << std::setw(8) << "Imbal" << "\n";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double imbalance = (stats.avg[p] > 0.0) ? stats.max[p] / stats.avg[p] : 1.0;
+        std::cout << std::left << std::setw(11) << phaseName((Phase)p) << std::right << std::fixed
+                  << std::setprecision(4) << std::setw(10) << stats.min[p] << std::setw(10) << stats.avg[p]
+                  << std::setw(10) << stats.max[p] << std::setprecision(2) << std::setw(8) << imbalance << "\n";
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef PHASE_TIMERS_H
+#define PHASE_TIMERS_H
+
+#include <mpi.h>
+#include "Trace.h"
+
+// Parts of an MPI solve that are timed separately
+enum Phase {
+    PHASE_COPY,      // Copies into and out of the sweep buffers
+    PHASE_HALO_POST, // Starting the halo exchange (nonblocking, persistent and RMA modes)
+    PHASE_HALO_WAIT, // Completing it; blocking exchanges count here entirely
+    PHASE_INTERIOR,
+    PHASE_EDGE,
+    PHASE_CHECK,     // Convergence checks and checkpoints
+    PHASE_MIGRATE,   // Moving rows between ranks when the strips are rebalanced
+    PHASE_GATHER,
+    PHASE_VERIFY,
+    PHASE_COUNT
+};
+
+const char* phaseName(Phase phase);
+
+// Per-rank seconds in each phase, accumulated over any number of solves. Every phase boundary
+// costs one MPI_Wtime call, so the timers can stay on in production runs.
+// With trace set, every phase is also recorded there as an event of the current iteration.
+struct PhaseTimers {
+    double seconds[PHASE_COUNT];
+    double mark;
+    int iteration;
+    TraceBuffer* trace;
+};
+
+// Zero the times; trace is left unset
+void resetPhaseTimers(PhaseTimers& timers);
+
+// Start timing at a phase boundary; timers may be NULL
+inline void phaseStart(PhaseTimers* timers) {
+    if (timers) timers->mark = MPI_Wtime();
+}
+
+// Charge the time since the last boundary to phase, which starts the next one
+inline void phaseEnd(PhaseTimers* timers, Phase phase) {
+    if (timers) {
+        double now = MPI_Wtime();
+        timers->seconds[phase] += now - timers->mark;
+        if (timers->trace) traceEvent(timers->trace, phaseName(phase), timers->mark, now, timers->iteration);
+        timers->mark = now;
+    }
+}
+
+// Min, average and max over the ranks of comm, valid on rank 0 of comm
+struct PhaseStats {
+    double min[PHASE_COUNT];
+    double avg[PHASE_COUNT];
+    double max[PHASE_COUNT];
+};
+
+PhaseStats reducePhaseTimers(const PhaseTimers& timers, MPI_Comm comm);
+
+// Table of the phases with their imbalance (max / avg)
+void printPhaseStats(const PhaseStats& stats);
+
+#endif
@@ -0,0 +1,237 @@
+// Including Packages
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+#include <omp.h>
+#include <mpi.h>
+#include "Placement.h"
+
+const char* rankPlacementName(RankPlacement placement) {
+    switch (placement) {
+        case PLACE_NODE: return "node";
+        case PLACE_GRAPH: return "graph";
+        default: return "launch";
+    }
+}
+
+bool parseRankPlacement(const std::string& name, RankPlacement& placement) {
+    if (name == "launch") placement = PLACE_LAUNCH;
+    else if (name == "node") placement = PLACE_NODE;
+    else if (name == "graph") placement = PLACE_GRAPH;
+    else return false;
+    return true;
+}
+
+MPI_Comm placeRanks(RankPlacement placement, MPI_Comm comm) {
+    MPI_Comm placed;
+    if (placement == PLACE_LAUNCH) {
+        MPI_Comm_dup(comm, &placed);
+        return placed;
+    }
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Every node is named by its lowest rank; a rank's new position is the number of ranks on
+    // nodes named lower plus its rank within the node
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    int node_rank, leader;
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Allreduce(&rank, &leader, 1, MPI_INT, MPI_MIN, node_comm);
+    MPI_Comm_free(&node_comm);
+    std::vector<int> leaders(size);
+    MPI_Allgather(&leader, 1, MPI_INT, &leaders[0], 1, MPI_INT, comm);
+    int position = node_rank;
+    for (int r = 0; r < size; r++) {
+        if (leaders[r] < leader) position++;
+    }
+    MPI_Comm_split(comm, 0, position, &placed);
+    if (placement == PLACE_NODE) return placed;
+
+    // Declare the strip chain and let MPI map it onto the machine, starting from the node order
+    int placed_rank;
+    MPI_Comm_rank(placed, &placed_rank);
+    int neighbors[2], count = 0;
+    if (placed_rank > 0) neighbors[count++] = placed_rank - 1;
+    if (placed_rank < size - 1) neighbors[count++] = placed_rank + 1;
+    MPI_Comm graph;
+    MPI_Dist_graph_create_adjacent(placed, count, neighbors, MPI_UNWEIGHTED, count, neighbors, MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL, 1, &graph);
+    MPI_Comm_free(&placed);
+    return graph;
+}
+
+#ifdef __linux__
+// Hardware threads sharing a core have the same package and core id
+static std::pair<int, int> coreOf(int cpu) {
+    std::stringstream base;
+    base << "/sys/devices/system/cpu/cpu" << cpu << "/topology/";
+    int package = 0, core = cpu;
+    std::ifstream package_file((base.str() + "physical_package_id").c_str());
+    std::ifstream core_file((base.str() + "core_id").c_str());
+    if (package_file && core_file) {
+        package_file >> package;
+        core_file >> core;
+    }
+    return std::make_pair(package, core);
+}
+
+// First of the environment variables that launchers set for the node-local rank and rank count
+static int launcherValue(const char* const* names, int fallback) {
+    for (int i = 0; names[i]; i++) {
+        const char* value = std::getenv(names[i]);
+        if (value && *value) return std::atoi(value);
+    }
+    return fallback;
+}
+
+void pinThreads(const std::string& places, char* argv[]) {
+    const char* pinned = std::getenv("LAPLACE_PLACES");
+    if (pinned && places == pinned) return; // Already restarted with them
+
+    std::string value = places;
+    if (places == "cores" || places == "threads") {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        sched_getaffinity(0, sizeof(mask), &mask);
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &mask)) cpus.push_back(c);
+        }
+
+        // Ranks still allowed on the whole node take consecutive slices of it
+        const char* local_rank_vars[] = {"OMPI_COMM_WORLD_LOCAL_RANK", "MPI_LOCALRANKID", "SLURM_LOCALID", NULL};
+        const char* local_size_vars[] = {"OMPI_COMM_WORLD_LOCAL_SIZE", "MPI_LOCALNRANKS", NULL};
+        int local_rank = launcherValue(local_rank_vars, 0);
+        int local_size = launcherValue(local_size_vars, 1);
+        int n = (int)cpus.size();
+        if (local_size > 1 && n > 0 && n == sysconf(_SC_NPROCESSORS_ONLN)) {
+            int begin = (int)((long)local_rank * n / local_size) % n;
+            int end = std::max(begin + 1, (int)((long)(local_rank + 1) * n / local_size));
+            cpus = std::vector<int>(cpus.begin() + begin, cpus.begin() + std::min(end, n));
+        }
+
+        // One place per CPU, or per core with all of its hardware threads
+        std::map<std::pair<int, int>, std::vector<int> > cores;
+        std::vector<std::pair<int, int> > core_order;
+        for (size_t i = 0; i < cpus.size(); i++) {
+            std::pair<int, int> core = (places == "cores") ? coreOf(cpus[i]) : std::make_pair(0, cpus[i]);
+            if (cores[core].empty()) core_order.push_back(core);
+            cores[core].push_back(cpus[i]);
+        }
+        std::stringstream list;
+        for (size_t i = 0; i < core_order.size(); i++) {
+            const std::vector<int>& ids = cores[core_order[i]];
+            list << (i > 0 ? "," : "") << "{";
+            for (size_t k = 0; k < ids.size(); k++) list << (k > 0 ? "," : "") << ids[k];
+            list << "}";
+        }
+        value = list.str();
+    }
+
+    setenv("OMP_PLACES", value.c_str(), 1);
+    setenv("OMP_PROC_BIND", "close", 1);
+    setenv("LAPLACE_PLACES", places.c_str(), 1);
+    execv("/proc/self/exe", argv);
+    std::cerr << "Could not restart with OMP_PLACES=" << value << ": " << std::strerror(errno) << "\n";
+}
+
+// CPUs of this process's OpenMP places as ranges, "-" without places
+static std::string placeCpus() {
+    std::vector<int> cpus;
+    for (int p = 0; p < omp_get_num_places(); p++) {
+        std::vector<int> ids(omp_get_place_num_procs(p));
+        if (!ids.empty()) omp_get_place_proc_ids(p, &ids[0]);
+        cpus.insert(cpus.end(), ids.begin(), ids.end());
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    if (cpus.empty()) return "-";
+    std::stringstream ss;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+        ss << (i > 0 ? "," : "") << cpus[i];
+        if (j > i) ss << "-" << cpus[j];
+        i = j;
+    }
+    return ss.str();
+}
+#else
+// Affinity masks and restarting through /proc/self/exe are Linux only
+void pinThreads(const std::string& places, char* argv[]) {
+    (void)argv;
+    std::cerr << "--places " << places << " needs Linux, OpenMP threads are not pinned\n";
+}
+
+static std::string placeCpus() {
+    return "-";
+}
+#endif
+
+// Strip neighbours (rank r and r + 1 of comm) that are on different nodes, valid on rank 0
+static int crossNodePairs(MPI_Comm comm, const char* host) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    std::vector<char> hosts(rank == 0 ? (size_t)size * MPI_MAX_PROCESSOR_NAME : 1);
+    MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, &hosts[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, comm);
+    int pairs = 0;
+    for (int r = 0; rank == 0 && r + 1 < size; r++) {
+        if (std::strcmp(&hosts[(size_t)r * MPI_MAX_PROCESSOR_NAME], &hosts[(size_t)(r + 1) * MPI_MAX_PROCESSOR_NAME]) != 0) {
+            pairs++;
+        }
+    }
+    return pairs;
+}
+
+void printPlacement(RankPlacement placement, MPI_Comm placed, MPI_Comm launched) {
+    int rank, size, launch_rank;
+    MPI_Comm_rank(placed, &rank);
+    MPI_Comm_size(placed, &size);
+    MPI_Comm_rank(launched, &launch_rank);
+
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int host_len;
+    std::memset(host, 0, sizeof(host));
+    MPI_Get_processor_name(host, &host_len);
+    int before = crossNodePairs(launched, host);
+    int after = crossNodePairs(placed, host);
+    // Rank 0 of launched may not be rank 0 of placed
+    MPI_Bcast(&before, 1, MPI_INT, 0, launched);
+
+    const int cpus_len = 64;
+    char cpus[cpus_len];
+    std::strncpy(cpus, placeCpus().c_str(), cpus_len - 1);
+    cpus[cpus_len - 1] = '\0';
+    std::vector<int> launch_ranks(size);
+    std::vector<char> hosts(rank == 0 ? (size_t)size * MPI_MAX_PROCESSOR_NAME : 1);
+    std::vector<char> all_cpus(rank == 0 ? (size_t)size * cpus_len : 1);
+    MPI_Gather(&launch_rank, 1, MPI_INT, &launch_ranks[0], 1, MPI_INT, 0, placed);
+    MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, &hosts[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, placed);
+    MPI_Gather(cpus, cpus_len, MPI_CHAR, &all_cpus[0], cpus_len, MPI_CHAR, 0, placed);
+    if (rank != 0) return;
+
+    std::cout << "Rank placement " << rankPlacementName(placement) << ": " << after << " of " << size - 1
+              << " strip neighbour pair(s) cross nodes (" << before << " as launched)";
+    if (const char* places = std::getenv("LAPLACE_PLACES")) std::cout << ", OpenMP threads pinned to " << places;
+    std::cout << "\n";
+    std::cout << std::left << std::setw(6) << "Rank" << std::setw(8) << "Launch" << std::setw(20) << "Node" << "CPUs\n";
+    for (int r = 0; r < size; r++) {
+        std::cout << std::left << std::setw(6) << r << std::setw(8) << launch_ranks[r] << std::setw(20)
+                  << &hosts[(size_t)r * MPI_MAX_PROCESSOR_NAME] << &all_cpus[(size_t)r * cpus_len] << "\n";
+    }
+    std::cout << "\n";
+}
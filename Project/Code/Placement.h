@@ -0,0 +1,34 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <string>
+#include <mpi.h>
+
+// How the MPI ranks are ordered before the grids are decomposed
+enum RankPlacement {
+    PLACE_LAUNCH, // As mpirun started them
+    PLACE_NODE,   // Grouped by node, so consecutive strips share a node and only node boundaries cross the network
+    PLACE_GRAPH   // Grouped by node, then MPI_Dist_graph_create_adjacent on the strip chain with reorder
+};
+
+const char* rankPlacementName(RankPlacement placement);
+bool parseRankPlacement(const std::string& name, RankPlacement& placement);
+
+// Communicator with the ranks of comm in placement order, free it with MPI_Comm_free. Nodes keep
+// the order of their lowest rank, so rank 0 stays rank 0 unless PLACE_GRAPH lets MPI move it.
+// Collective.
+MPI_Comm placeRanks(RankPlacement placement, MPI_Comm comm);
+
+// Pin OpenMP threads to this rank's share of the node. OpenMP reads OMP_PLACES once at startup, so
+// this sets OMP_PLACES and OMP_PROC_BIND=close and restarts the process; call it first in main,
+// before MPI_Init. places is "cores" or "threads" (a place per core or hardware thread of the
+// CPUs left to this rank; ranks the launcher did not bind split the node between them by their
+// node-local rank) or any other OMP_PLACES value, which is used as is. Linux only; elsewhere it
+// only prints that the threads stay unpinned.
+void pinThreads(const std::string& places, char* argv[]);
+
+// Table of every rank of placed with its launch rank, node and the CPUs of its OpenMP places, and
+// how many strip neighbours are on different nodes before and after placement (rank 0 of placed)
+void printPlacement(RankPlacement placement, MPI_Comm placed, MPI_Comm launched);
+
+#endif
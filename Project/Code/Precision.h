@@ -0,0 +1,23 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include <string>
+#include <mpi.h>
+
+// Element type of the sweeps
+enum Precision {
+    PRECISION_DOUBLE,
+    PRECISION_FLOAT, // Every sweep in float: half the bytes per point and per halo row
+    PRECISION_MIXED  // Float sweeps on a correction, refined against a double residual (iterative refinement)
+};
+
+// Defined in MPILaplace.cpp
+const char* precisionName(Precision precision);
+bool parsePrecision(const std::string& name, Precision& precision);
+
+// MPI datatype of a grid element type
+template <typename T> inline MPI_Datatype mpiType();
+template <> inline MPI_Datatype mpiType<double>() { return MPI_DOUBLE; }
+template <> inline MPI_Datatype mpiType<float>() { return MPI_FLOAT; }
+
+#endif
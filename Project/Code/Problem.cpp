@@ -0,0 +1,60 @@
+// Including Packages
+#include <sstream>
+#include <mpi.h>
+#include "Problem.h"
+#include "GridIO.h"
+
+const char* boundaryKindName(BoundaryKind kind) {
+    switch (kind) {
+        case BOUNDARY_NEUMANN: return "neumann";
+        case BOUNDARY_PERIODIC: return "periodic";
+        default: return "dirichlet";
+    }
+}
+
+bool parseBoundaryKind(const std::string& name, BoundaryKind& kind) {
+    if (name == "dirichlet") kind = BOUNDARY_DIRICHLET;
+    else if (name == "neumann") kind = BOUNDARY_NEUMANN;
+    else if (name == "periodic") kind = BOUNDARY_PERIODIC;
+    else return false;
+    return true;
+}
+
+bool isBuiltinProblem(const Problem& problem) {
+    return problem.boundaries.x == BOUNDARY_DIRICHLET && problem.boundaries.y == BOUNDARY_DIRICHLET &&
+           problem.source_path.empty() && problem.values_path.empty();
+}
+
+std::string problemFile(const std::string& path, int xsize, int ysize) {
+    std::stringstream ss;
+    ss << path << "_size_" << xsize;
+    if (ysize != xsize) ss << "x" << ysize;
+    ss << ".bin";
+    return ss.str();
+}
+
+// Read a block of path's grid file, if there is a usable one
+static bool readProblemGrid(const std::string& path, double* block, int ld, int x0, int lx, int y0, int ly,
+                            int xsize, int ysize, MPI_Comm comm) {
+    if (path.empty()) return false;
+    std::string file = problemFile(path, xsize, ysize);
+    if (gridFileIterations(file.c_str(), xsize, ysize, comm) < 0) return false;
+    readGridMPIIO(file.c_str(), block, ld, x0, lx, y0, ly, xsize, ysize, comm);
+    return true;
+}
+
+bool readProblemSource(const Problem& problem, double* block, int ld, int x0, int lx, int y0, int ly,
+                       int xsize, int ysize, MPI_Comm comm) {
+    if (!readProblemGrid(problem.source_path, block, ld, x0, lx, y0, ly, xsize, ysize, comm)) return false;
+    double h = 1.0 / (xsize - 1);
+    double scale = 0.25 * h * h;
+    for (int x = 0; x < lx; x++) {
+        for (int y = 0; y < ly; y++) block[(size_t)x * ld + y] *= scale;
+    }
+    return true;
+}
+
+bool readProblemValues(const Problem& problem, double* block, int ld, int x0, int lx, int y0, int ly,
+                       int xsize, int ysize, MPI_Comm comm) {
+    return readProblemGrid(problem.values_path, block, ld, x0, lx, y0, ly, xsize, ysize, comm);
+}
@@ -0,0 +1,51 @@
+#ifndef PROBLEM_H
+#define PROBLEM_H
+
+#include <string>
+#include <mpi.h>
+
+// Boundary condition of a pair of opposite sides
+enum BoundaryKind {
+    BOUNDARY_DIRICHLET, // Fixed values; the sides are never updated
+    BOUNDARY_NEUMANN,   // Zero normal derivative; the sides are updated with their inner neighbour mirrored outwards
+    BOUNDARY_PERIODIC   // The sides are updated with the opposite side as their outer neighbour
+};
+
+const char* boundaryKindName(BoundaryKind kind);
+bool parseBoundaryKind(const std::string& name, BoundaryKind& kind);
+
+// Boundary conditions of rows 0 and xsize-1 (x) and of columns 0 and ysize-1 (y). Value-initialized
+// it is Dirichlet on all four sides. The sweeps pick the neighbour rows of a side once per row and
+// fix up the two ends of a row once per row, so the stencil kernels never branch per point.
+struct Boundaries {
+    BoundaryKind x;
+    BoundaryKind y;
+};
+
+// What the solvers solve: -laplace(u) = f on a grid of spacing h = 1 / (xsize - 1), so every sweep
+// sets u to the average of its neighbours plus h^2 f / 4. The default (no files, Dirichlet sides) is
+// the built-in Laplace problem: f = 0, 5 on top, -5 at the bottom and 0 on the left and right.
+// Files are binary grid files (see GridIO.h) of either element type, named <path>_size_<n>.bin like
+// the reference files, so one path serves every grid size.
+struct Problem {
+    Boundaries boundaries;
+    std::string source_path; // f; none when empty
+    std::string values_path; // Initial grid, which holds the Dirichlet values; built in when empty
+};
+
+bool isBuiltinProblem(const Problem& problem);
+
+// <path>_size_<n>.bin, or <path>_size_<x>x<y>.bin for a rectangular grid
+std::string problemFile(const std::string& path, int xsize, int ysize);
+
+// Read global rows [x0, x0+lx) and columns [y0, y0+ly) of the source into block (row length ld),
+// scaled to the h^2 f / 4 a sweep adds. Collective over comm; returns false and leaves block
+// untouched when the problem has no source or its file is missing or holds another grid size.
+bool readProblemSource(const Problem& problem, double* block, int ld, int x0, int lx, int y0, int ly,
+                       int xsize, int ysize, MPI_Comm comm);
+
+// The same for the initial values
+bool readProblemValues(const Problem& problem, double* block, int ld, int x0, int lx, int y0, int ly,
+                       int xsize, int ysize, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,131 @@
+// Including Packages
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+#include <mpi.h>
+#include "Laplace.h"
+#include "SOR.h"
+
+double optimalOmega(int xsize, int ysize) {
+    // Jacobi spectral radius for the Dirichlet problem, then omega = 2 / (1 + sqrt(1 - rho^2))
+    const double pi = std::acos(-1.0);
+    double rho = 0.5 * (std::cos(pi / (xsize - 1)) + std::cos(pi / (ysize - 1)));
+    return 2.0 / (1.0 + std::sqrt(1.0 - rho * rho));
+}
+
+// Update the points of one colour in row x (global row gx) and return the largest change;
+// a point's colour is the parity of its global x + y
+static inline double sorRow(double* row, const double* up, const double* down, int gx, int colour, int ysize, double omega) {
+    double delta = 0.0;
+    for (int y = 1 + (gx + 1 + colour) % 2; y < ysize - 1; y += 2) {
+        double gs = 0.25 * (up[y] + down[y] + row[y-1] + row[y+1]);
+        double change = omega * (gs - row[y]);
+        row[y] += change;
+        delta = std::max(delta, std::abs(change));
+    }
+    return delta;
+}
+
+int serialSOR(double* u, int xsize, int ysize, double omega, double tol, int max_iter, double* residual) {
+    double delta = 0.0;
+    int iter = 0;
+    while (iter < max_iter) {
+        delta = 0.0;
+        for (int colour = 0; colour < 2; colour++) {
+            for (int x = 1; x < xsize - 1; x++) {
+                delta = std::max(delta, sorRow(u + (size_t)x * ysize, u + (size_t)(x-1) * ysize, u + (size_t)(x+1) * ysize, x, colour, ysize, omega));
+            }
+        }
+        iter++;
+        if (delta < tol) break;
+    }
+    if (residual) *residual = delta;
+    return iter;
+}
+
+int openMPSOR(double* u, int xsize, int ysize, double omega, double tol, int max_iter, int numThreads, double* residual) {
+    omp_set_num_threads(numThreads);
+    double delta = 0.0;
+    int iter = 0;
+    while (iter < max_iter) {
+        delta = 0.0;
+        for (int colour = 0; colour < 2; colour++) {
+            double colour_delta = 0.0;
+            #pragma omp parallel for reduction(max:colour_delta)
+            for (int x = 1; x < xsize - 1; x++) {
+                colour_delta = std::max(colour_delta, sorRow(u + (size_t)x * ysize, u + (size_t)(x-1) * ysize, u + (size_t)(x+1) * ysize, x, colour, ysize, omega));
+            }
+            delta = std::max(delta, colour_delta);
+        }
+        iter++;
+        if (delta < tol) break;
+    }
+    if (residual) *residual = delta;
+    return iter;
+}
+
+double mpiSOR(double* local_u, int local_rows, int global_xsize, int ysize, int rank, int size, double omega,
+              double tol, int max_iter, double* reference, int* iterations, double* residual, MPI_Comm comm) {
+    // Rows per rank and first global row of each rank
+    std::vector<int> counts(size), displs(size);
+    MPI_Allgather(&local_rows, 1, MPI_INT, &counts[0], 1, MPI_INT, comm);
+    int offset = 0;
+    for (int i = 0; i < size; i++) {
+        displs[i] = offset;
+        offset += counts[i];
+    }
+    int row0 = displs[rank];
+
+    double* upper_halo = new double[ysize];
+    double* lower_halo = new double[ysize];
+    int upper_neighbor = (rank == 0) ? MPI_PROC_NULL : rank - 1;
+    int lower_neighbor = (rank == size - 1) ? MPI_PROC_NULL : rank + 1;
+
+    // Owned rows that are not on the global boundary
+    int xa = std::max(0, 1 - row0);
+    int xb = std::min(local_rows, global_xsize - 1 - row0);
+
+    // A strip without rows has nothing to send
+    int send_count = (local_rows == 0) ? 0 : ysize;
+    int last_row = std::max(local_rows - 1, 0);
+
+    double delta = 0.0;
+    int iter = 0;
+    while (iter < max_iter) {
+        double local_delta = 0.0;
+        for (int colour = 0; colour < 2; colour++) {
+            // Halos must hold the other colour's latest values before this colour is updated
+            MPI_Sendrecv(local_u + (size_t)last_row * ysize, send_count, MPI_DOUBLE, lower_neighbor, 0,
+                         upper_halo, ysize, MPI_DOUBLE, upper_neighbor, 0, comm, MPI_STATUS_IGNORE);
+            MPI_Sendrecv(local_u, send_count, MPI_DOUBLE, upper_neighbor, 1,
+                         lower_halo, ysize, MPI_DOUBLE, lower_neighbor, 1, comm, MPI_STATUS_IGNORE);
+            for (int x = xa; x < xb; x++) {
+                const double* up = (x == 0) ? upper_halo : local_u + (size_t)(x-1) * ysize;
+                const double* down = (x == local_rows - 1) ? lower_halo : local_u + (size_t)(x+1) * ysize;
+                local_delta = std::max(local_delta, sorRow(local_u + (size_t)x * ysize, up, down, row0 + x, colour, ysize, omega));
+            }
+        }
+        MPI_Allreduce(&local_delta, &delta, 1, MPI_DOUBLE, MPI_MAX, comm);
+        iter++;
+        if (delta < tol) break;
+    }
+    if (iterations) *iterations = iter;
+    if (residual) *residual = delta;
+
+    double* global_u = NULL;
+    if (rank == 0) global_u = new double[(size_t)global_xsize * ysize];
+    MPI_Datatype row_type = rowType(ysize);
+    MPI_Gatherv(local_u, local_rows, row_type, global_u, &counts[0], &displs[0], row_type, 0, comm);
+    MPI_Type_free(&row_type);
+    double diff = 0.0;
+    if (rank == 0) {
+        diff = diffMat(global_u, reference, global_xsize, ysize);
+        delete[] global_u;
+    }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, comm);
+
+    delete[] upper_halo;
+    delete[] lower_halo;
+    return diff;
+}
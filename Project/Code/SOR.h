@@ -0,0 +1,22 @@
+#ifndef SOR_H
+#define SOR_H
+
+#include <mpi.h>
+
+// Over-relaxation factor that minimises the spectral radius of red-black SOR for the
+// 5-point Laplacian on an xsize x ysize grid
+double optimalOmega(int xsize, int ysize);
+
+// In-place red-black Gauss-Seidel / SOR solvers (omega = 1 is plain Gauss-Seidel). They sweep
+// until the largest change of a sweep is below tol or max_iter sweeps have run, return the
+// number of sweeps and put the last max change in *residual.
+int serialSOR(double* u, int xsize, int ysize, double omega, double tol, int max_iter, double* residual);
+int openMPSOR(double* u, int xsize, int ysize, double omega, double tol, int max_iter, int numThreads, double* residual);
+
+// MPI variant on the mpiLaplace row strips, halos are exchanged before each colour. Returns the
+// difference to reference (only read on rank 0), the sweep count goes to *iterations; rank and size are within comm.
+double mpiSOR(double* local_u, int local_rows, int global_xsize, int ysize, int rank, int size, double omega,
+              double tol, int max_iter, double* reference, int* iterations, double* residual,
+              MPI_Comm comm = MPI_COMM_WORLD);
+
+#endif
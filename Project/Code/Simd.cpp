@@ -0,0 +1,291 @@
+// Including Packages
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include "Simd.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+bool parseSimdLevel(const std::string& name, SimdLevel& level) {
+    if (name == "scalar") level = SIMD_SCALAR;
+    else if (name == "avx2") level = SIMD_AVX2;
+    else if (name == "avx512") level = SIMD_AVX512;
+    else if (name == "auto") level = detectSimdLevel();
+    else return false;
+    return true;
+}
+
+SimdLevel detectSimdLevel() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#endif
+    return SIMD_SCALAR;
+}
+
+template <typename T>
+static void stencilScalar(T* out, const T* up, const T* mid, const T* down, const T* source, int ya, int yb) {
+    const T quarter = 0.25;
+    if (source) {
+        for (int y = ya; y < yb; y++) {
+            out[y] = quarter * (up[y] + down[y] + mid[y-1] + mid[y+1]) + source[y];
+        }
+        return;
+    }
+    for (int y = ya; y < yb; y++) {
+        out[y] = quarter * (up[y] + down[y] + mid[y-1] + mid[y+1]);
+    }
+}
+
+// 7-point version for 3D grids: the rows before and after in x and in y, and the row itself
+static void stencil7Scalar(double* out, const double* xm, const double* xp, const double* ym, const double* yp,
+                           const double* mid, int za, int zb) {
+    const double sixth = 1.0 / 6.0;
+    for (int z = za; z < zb; z++) {
+        out[z] = sixth * (xm[z] + xp[z] + ym[z] + yp[z] + mid[z-1] + mid[z+1]);
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// Scalar points until out + y is 64-byte aligned, so the vector stores are aligned;
+// the loads are unaligned because the left/right neighbours are offset by one element.
+// The source is added after the multiply, as in the scalar loop, so the kernels still agree bit for bit.
+template <typename T>
+static inline int alignedStart(const T* out, int ya, int yb) {
+    int y = ya;
+    while (y < yb && ((uintptr_t)(out + y) & (SIMD_ALIGN - 1)) != 0) y++;
+    return y;
+}
+
+__attribute__((target("avx2")))
+static void stencilAVX2(double* out, const double* up, const double* mid, const double* down, const double* source, int ya, int yb) {
+    int y = alignedStart(out, ya, yb);
+    stencilScalar(out, up, mid, down, source, ya, y);
+    const __m256d quarter = _mm256_set1_pd(0.25);
+    for (; y + 4 <= yb; y += 4) {
+        __m256d s = _mm256_add_pd(_mm256_loadu_pd(up + y), _mm256_loadu_pd(down + y));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(mid + y - 1));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(mid + y + 1));
+        s = _mm256_mul_pd(quarter, s);
+        if (source) s = _mm256_add_pd(s, _mm256_loadu_pd(source + y));
+        _mm256_store_pd(out + y, s);
+    }
+    stencilScalar(out, up, mid, down, source, y, yb);
+}
+
+__attribute__((target("avx512f")))
+static void stencilAVX512(double* out, const double* up, const double* mid, const double* down, const double* source, int ya, int yb) {
+    int y = alignedStart(out, ya, yb);
+    stencilScalar(out, up, mid, down, source, ya, y);
+    const __m512d quarter = _mm512_set1_pd(0.25);
+    for (; y + 8 <= yb; y += 8) {
+        __m512d s = _mm512_add_pd(_mm512_loadu_pd(up + y), _mm512_loadu_pd(down + y));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(mid + y - 1));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(mid + y + 1));
+        s = _mm512_mul_pd(quarter, s);
+        if (source) s = _mm512_add_pd(s, _mm512_loadu_pd(source + y));
+        _mm512_store_pd(out + y, s);
+    }
+    stencilScalar(out, up, mid, down, source, y, yb);
+}
+
+// Float versions: twice the points per vector
+__attribute__((target("avx2")))
+static void stencilAVX2(float* out, const float* up, const float* mid, const float* down, const float* source, int ya, int yb) {
+    int y = alignedStart(out, ya, yb);
+    stencilScalar(out, up, mid, down, source, ya, y);
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    for (; y + 8 <= yb; y += 8) {
+        __m256 s = _mm256_add_ps(_mm256_loadu_ps(up + y), _mm256_loadu_ps(down + y));
+        s = _mm256_add_ps(s, _mm256_loadu_ps(mid + y - 1));
+        s = _mm256_add_ps(s, _mm256_loadu_ps(mid + y + 1));
+        s = _mm256_mul_ps(quarter, s);
+        if (source) s = _mm256_add_ps(s, _mm256_loadu_ps(source + y));
+        _mm256_store_ps(out + y, s);
+    }
+    stencilScalar(out, up, mid, down, source, y, yb);
+}
+
+__attribute__((target("avx512f")))
+static void stencilAVX512(float* out, const float* up, const float* mid, const float* down, const float* source, int ya, int yb) {
+    int y = alignedStart(out, ya, yb);
+    stencilScalar(out, up, mid, down, source, ya, y);
+    const __m512 quarter = _mm512_set1_ps(0.25f);
+    for (; y + 16 <= yb; y += 16) {
+        __m512 s = _mm512_add_ps(_mm512_loadu_ps(up + y), _mm512_loadu_ps(down + y));
+        s = _mm512_add_ps(s, _mm512_loadu_ps(mid + y - 1));
+        s = _mm512_add_ps(s, _mm512_loadu_ps(mid + y + 1));
+        s = _mm512_mul_ps(quarter, s);
+        if (source) s = _mm512_add_ps(s, _mm512_loadu_ps(source + y));
+        _mm512_store_ps(out + y, s);
+    }
+    stencilScalar(out, up, mid, down, source, y, yb);
+}
+
+__attribute__((target("avx2")))
+static void stencil7AVX2(double* out, const double* xm, const double* xp, const double* ym, const double* yp,
+                         const double* mid, int za, int zb) {
+    int z = alignedStart(out, za, zb);
+    stencil7Scalar(out, xm, xp, ym, yp, mid, za, z);
+    const __m256d sixth = _mm256_set1_pd(1.0 / 6.0);
+    for (; z + 4 <= zb; z += 4) {
+        __m256d s = _mm256_add_pd(_mm256_loadu_pd(xm + z), _mm256_loadu_pd(xp + z));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(ym + z));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(yp + z));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(mid + z - 1));
+        s = _mm256_add_pd(s, _mm256_loadu_pd(mid + z + 1));
+        _mm256_store_pd(out + z, _mm256_mul_pd(sixth, s));
+    }
+    stencil7Scalar(out, xm, xp, ym, yp, mid, z, zb);
+}
+
+__attribute__((target("avx512f")))
+static void stencil7AVX512(double* out, const double* xm, const double* xp, const double* ym, const double* yp,
+                           const double* mid, int za, int zb) {
+    int z = alignedStart(out, za, zb);
+    stencil7Scalar(out, xm, xp, ym, yp, mid, za, z);
+    const __m512d sixth = _mm512_set1_pd(1.0 / 6.0);
+    for (; z + 8 <= zb; z += 8) {
+        __m512d s = _mm512_add_pd(_mm512_loadu_pd(xm + z), _mm512_loadu_pd(xp + z));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(ym + z));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(yp + z));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(mid + z - 1));
+        s = _mm512_add_pd(s, _mm512_loadu_pd(mid + z + 1));
+        _mm512_store_pd(out + z, _mm512_mul_pd(sixth, s));
+    }
+    stencil7Scalar(out, xm, xp, ym, yp, mid, z, zb);
+}
+#endif
+
+typedef void (*StencilKernel)(double*, const double*, const double*, const double*, const double*, int, int);
+typedef void (*StencilKernelFloat)(float*, const float*, const float*, const float*, const float*, int, int);
+typedef void (*Stencil7Kernel)(double*, const double*, const double*, const double*, const double*, const double*, int, int);
+
+static SimdLevel active_level = SIMD_SCALAR;
+static StencilKernel active_kernel = stencilScalar<double>;
+static StencilKernelFloat active_kernel_float = stencilScalar<float>;
+static Stencil7Kernel active_kernel7 = stencil7Scalar;
+
+SimdLevel setSimdLevel(SimdLevel level) {
+    SimdLevel best = detectSimdLevel();
+    if (level > best) level = best;
+    active_level = level;
+    active_kernel = stencilScalar<double>;
+    active_kernel_float = stencilScalar<float>;
+    active_kernel7 = stencil7Scalar;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    if (level == SIMD_AVX2) {
+        active_kernel = stencilAVX2;
+        active_kernel_float = stencilAVX2;
+        active_kernel7 = stencil7AVX2;
+    } else if (level == SIMD_AVX512) {
+        active_kernel = stencilAVX512;
+        active_kernel_float = stencilAVX512;
+        active_kernel7 = stencil7AVX512;
+    }
+#endif
+    return level;
+}
+
+SimdLevel currentSimdLevel() {
+    return active_level;
+}
+
+void stencilRow(double* out, const double* up, const double* mid, const double* down, int ya, int yb) {
+    active_kernel(out, up, mid, down, NULL, ya, yb);
+}
+
+void stencilRow(float* out, const float* up, const float* mid, const float* down, int ya, int yb) {
+    active_kernel_float(out, up, mid, down, NULL, ya, yb);
+}
+
+void stencilRow(double* out, const double* up, const double* mid, const double* down, const double* source, int ya, int yb) {
+    active_kernel(out, up, mid, down, source, ya, yb);
+}
+
+void stencilRow(float* out, const float* up, const float* mid, const float* down, const float* source, int ya, int yb) {
+    active_kernel_float(out, up, mid, down, source, ya, yb);
+}
+
+void stencilRow7(double* out, const double* xm, const double* xp, const double* ym, const double* yp,
+                 const double* mid, int za, int zb) {
+    active_kernel7(out, xm, xp, ym, yp, mid, za, zb);
+}
+
+int paddedRow(int n) {
+    const int width = SIMD_ALIGN / (int)sizeof(double);
+    return (n + width - 1) / width * width;
+}
+
+static bool huge_pages = false;
+
+void setHugePages(bool on) {
+    huge_pages = on;
+}
+
+bool hugePagesEnabled() {
+    return huge_pages;
+}
+
+// Every allocation starts with one SIMD_ALIGN block holding how many bytes were mapped with mmap,
+// 0 for the heap, so freeAligned knows how to release it
+double* allocAligned(size_t count) {
+    size_t bytes = (count > 0 ? count : 1) * sizeof(double) + SIMD_ALIGN;
+    char* block = NULL;
+    size_t mapped = 0;
+#ifdef _WIN32
+    block = static_cast<char*>(_aligned_malloc(bytes, SIMD_ALIGN));
+    if (block == NULL) return NULL;
+#else
+    if (huge_pages && bytes >= HUGE_PAGE_BYTES) {
+        // Map one huge page more than needed and trim it, so the block starts on a huge page boundary
+        size_t length = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+        void* m = mmap(NULL, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m != MAP_FAILED) {
+            char* start = static_cast<char*>(m);
+            char* aligned = start + (HUGE_PAGE_BYTES - (uintptr_t)start % HUGE_PAGE_BYTES) % HUGE_PAGE_BYTES;
+            if (aligned > start) munmap(start, aligned - start);
+            munmap(aligned + length, start + HUGE_PAGE_BYTES - aligned);
+#ifdef MADV_HUGEPAGE
+            madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+            block = aligned;
+            mapped = length;
+        }
+    }
+    if (block == NULL) {
+        void* p = NULL;
+        if (posix_memalign(&p, SIMD_ALIGN, bytes) != 0) return NULL;
+        block = static_cast<char*>(p);
+    }
+#endif
+    *reinterpret_cast<size_t*>(block) = mapped;
+    return reinterpret_cast<double*>(block + SIMD_ALIGN);
+}
+
+void freeAligned(double* p) {
+    if (p == NULL) return;
+    char* block = reinterpret_cast<char*>(p) - SIMD_ALIGN;
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    size_t mapped = *reinterpret_cast<size_t*>(block);
+    if (mapped > 0) munmap(block, mapped);
+    else std::free(block);
+#endif
+}
@@ -0,0 +1,58 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <string>
+
+// Instruction sets the stencil kernel can run with
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+const char* simdLevelName(SimdLevel level);
+bool parseSimdLevel(const std::string& name, SimdLevel& level);
+
+// Best instruction set this CPU supports
+SimdLevel detectSimdLevel();
+
+// Select the kernel used by stencilRow; a level the CPU lacks falls back to the best one it has.
+// Returns the level actually selected.
+SimdLevel setSimdLevel(SimdLevel level);
+SimdLevel currentSimdLevel();
+
+// Jacobi update of out[y] for y in [ya, yb) from the rows above and below and the row itself.
+// Same operation order as the scalar loops, so every level gives bit-identical results.
+void stencilRow(double* out, const double* up, const double* mid, const double* down, int ya, int yb);
+void stencilRow(float* out, const float* up, const float* mid, const float* down, int ya, int yb);
+// The same update plus source[y], fused into one pass: out = avg + source (source may be NULL)
+void stencilRow(double* out, const double* up, const double* mid, const double* down, const double* source, int ya, int yb);
+void stencilRow(float* out, const float* up, const float* mid, const float* down, const float* source, int ya, int yb);
+// 7-point update of a 3D grid row: out[z] for z in [za, zb) is the average of the rows before (xm, ym)
+// and after (xp, yp) it in x and y and of its neighbours in the row itself
+void stencilRow7(double* out, const double* xm, const double* xp, const double* ym, const double* yp,
+                 const double* mid, int za, int zb);
+
+// Rows are padded to a whole number of 64-byte vectors, allocations are 64-byte aligned
+const int SIMD_ALIGN = 64;
+int paddedRow(int n);
+double* allocAligned(size_t count);
+void freeAligned(double* p);
+
+// Aligned arrays of other element types come from the same allocator
+template <typename T> T* allocAlignedAs(size_t count) {
+    return reinterpret_cast<T*>(allocAligned((count * sizeof(T) + sizeof(double) - 1) / sizeof(double)));
+}
+inline void freeAligned(float* p) {
+    freeAligned(reinterpret_cast<double*>(p));
+}
+
+// With huge pages on, allocations of at least HUGE_PAGE_BYTES are mmap'ed on a 2 MiB boundary and
+// marked MADV_HUGEPAGE, so transparent huge pages back them and a grid needs far fewer TLB entries.
+// Pages still land on the NUMA node of the thread that first writes them.
+const size_t HUGE_PAGE_BYTES = 2 << 20;
+void setHugePages(bool on);
+bool hugePagesEnabled();
+
+#endif
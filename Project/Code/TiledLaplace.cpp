@@ -0,0 +1,68 @@
+// Including Packages
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+#include "Laplace.h"
+#include "TiledLaplace.h"
+#include "Simd.h"
+
+// Jacobi update of rows [xa, xb) from src into dst
+static inline void sweepRows(double* dst, const double* src, int xa, int xb, int ysize) {
+    for (int x = xa; x < xb; x++) {
+        stencilRow(dst + (size_t)x * ysize, src + (size_t)(x-1) * ysize, src + (size_t)x * ysize, src + (size_t)(x+1) * ysize, 1, ysize - 1);
+    }
+}
+
+double tiledLaplace(double* u, double* uu, int xsize, int ysize, int iter, int numThreads,
+                    int tileRows, int tileSteps, double* serial_u) {
+    omp_set_num_threads(numThreads);
+    int steps = std::max(1, tileSteps);
+    int rows_per_tile = std::max(tileRows, 2 * steps);
+
+    // Tiles split the interior rows [1, xsize-1) evenly, each at least rows_per_tile rows
+    int interior = xsize - 2;
+    int ntiles = std::max(1, interior / rows_per_tile);
+    std::vector<int> edges(ntiles + 1);
+    for (int t = 0; t < ntiles; t++) {
+        edges[t] = 1 + (int)((long long)t * interior / ntiles);
+    }
+    edges[ntiles] = xsize - 1;
+
+    #pragma omp parallel for
+    for (int x = 0; x < xsize; x++) {
+        for (int y = 0; y < ysize; y++) {
+            uu[(size_t)x * ysize + y] = u[(size_t)x * ysize + y];
+        }
+    }
+
+    // Sweep number n is written to buffers[n % 2]; both buffers always keep the boundary
+    double* buffers[2] = {u, uu};
+    int done = 0;
+    while (done < iter) {
+        int T = std::min(steps, iter - done);
+
+        // Upright trapezoids: tile [a,b) computes level k on [a+k-1, b-k+1), which only needs
+        // its own rows plus the level-0 rows a-1 and b; sides on the global boundary don't shrink
+        #pragma omp parallel for schedule(dynamic)
+        for (int t = 0; t < ntiles; t++) {
+            for (int k = 1; k <= T; k++) {
+                int xa = (t == 0) ? edges[t] : edges[t] + k - 1;
+                int xb = (t == ntiles - 1) ? edges[t + 1] : edges[t + 1] - k + 1;
+                sweepRows(buffers[(done + k) % 2], buffers[(done + k - 1) % 2], xa, xb, ysize);
+            }
+        }
+
+        // Inverted trapezoids fill the gap around each inner tile edge e: level k on [e-k+1, e+k-1).
+        // The rows they read hold exactly levels k-1 and k in the two buffers at that point.
+        #pragma omp parallel for schedule(dynamic)
+        for (int t = 1; t < ntiles; t++) {
+            int e = edges[t];
+            for (int k = 2; k <= T; k++) {
+                sweepRows(buffers[(done + k) % 2], buffers[(done + k - 1) % 2], e - k + 1, e + k - 1, ysize);
+            }
+        }
+        done += T;
+    }
+    if (done % 2 == 1) std::copy(uu, uu + (size_t)xsize * ysize, u);
+    return diffMat(u, serial_u, xsize, ysize);
+}
@@ -0,0 +1,12 @@
+#ifndef TILED_LAPLACE_H
+#define TILED_LAPLACE_H
+
+// Temporally blocked OpenMP Jacobi solver. Rows are cut into tiles of about tileRows rows and
+// each tile advances tileSteps sweeps while it is still in cache: first as shrinking
+// (upright) trapezoids, then the gaps between tiles as growing (inverted) trapezoids.
+// Every point gets exactly the same arithmetic as openMPLaplace, so the result is bit-identical.
+// tileRows is raised to 2 * tileSteps if needed. Returns the difference to serial_u.
+double tiledLaplace(double* u, double* uu, int xsize, int ysize, int iter, int numThreads,
+                    int tileRows, int tileSteps, double* serial_u);
+
+#endif
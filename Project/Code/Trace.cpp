@@ -0,0 +1,125 @@
+// Including Packages
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <mpi.h>
+#include "Trace.h"
+
+void openTrace(TraceBuffer& trace, size_t capacity) {
+    trace.events.assign(capacity, TraceEvent());
+    trace.next = 0;
+    trace.recorded = 0;
+}
+
+double traceClockOffset(MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int* is_global = NULL;
+    int flag = 0;
+    MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_WTIME_IS_GLOBAL, &is_global, &flag);
+    if (flag && *is_global) return 0.0;
+
+    // Rank 0 pings every rank in turn; the reply carries the remote clock, which is assumed
+    // to have been read halfway through the round trip
+    const int rounds = 10;
+    double offset = 0.0;
+    for (int r = 1; r < size; r++) {
+        if (rank == 0) {
+            double best_rtt = 0.0, best = 0.0;
+            for (int k = 0; k < rounds; k++) {
+                double t0 = MPI_Wtime();
+                double remote;
+                MPI_Send(&t0, 1, MPI_DOUBLE, r, 0, comm);
+                MPI_Recv(&remote, 1, MPI_DOUBLE, r, 0, comm, MPI_STATUS_IGNORE);
+                double t1 = MPI_Wtime();
+                if (k == 0 || t1 - t0 < best_rtt) {
+                    best_rtt = t1 - t0;
+                    best = remote - 0.5 * (t0 + t1);
+                }
+            }
+            MPI_Send(&best, 1, MPI_DOUBLE, r, 1, comm);
+        } else if (rank == r) {
+            for (int k = 0; k < rounds; k++) {
+                double ping;
+                MPI_Recv(&ping, 1, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+                double now = MPI_Wtime();
+                MPI_Send(&now, 1, MPI_DOUBLE, 0, 0, comm);
+            }
+            MPI_Recv(&offset, 1, MPI_DOUBLE, 0, 1, comm, MPI_STATUS_IGNORE);
+        }
+    }
+    return offset;
+}
+
+bool writeChromeTrace(const TraceBuffer& trace, const char* filename, MPI_Comm comm) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    double offset = traceClockOffset(comm);
+
+    // Oldest event first; the ring only holds the last events.size() of them
+    size_t capacity = trace.events.size();
+    size_t kept = std::min(trace.recorded, capacity);
+    size_t start = (trace.recorded > capacity) ? trace.next : 0;
+
+    // Timestamps count from the earliest event of any rank
+    double local_first = 1e300;
+    for (size_t k = 0; k < kept; k++) {
+        local_first = std::min(local_first, trace.events[(start + k) % capacity].begin - offset);
+    }
+    double first;
+    MPI_Allreduce(&local_first, &first, 1, MPI_DOUBLE, MPI_MIN, comm);
+
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int host_len;
+    MPI_Get_processor_name(host, &host_len);
+    host[host_len] = '\0';
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank << ",\"args\":{\"name\":\"rank " << rank
+        << " (" << host << ")\"}},\n";
+    out << "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":" << rank << ",\"args\":{\"sort_index\":" << rank << "}},\n";
+    if (trace.recorded > capacity) {
+        out << "{\"name\":\"dropped " << trace.recorded - capacity << " older events\",\"ph\":\"i\",\"s\":\"p\",\"pid\":"
+            << rank << ",\"tid\":0,\"ts\":0.000},\n";
+    }
+    for (size_t k = 0; k < kept; k++) {
+        const TraceEvent& e = trace.events[(start + k) % capacity];
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"mpi\",\"ph\":\"X\",\"pid\":" << rank << ",\"tid\":0"
+            << ",\"ts\":" << (e.begin - offset - first) * 1e6 << ",\"dur\":" << (e.end - e.begin) * 1e6
+            << ",\"args\":{\"iteration\":" << e.iteration << "}},\n";
+    }
+    std::string local = out.str();
+
+    // Rank 0 collects every rank's lines and writes the file
+    int length = (int)local.size();
+    std::vector<int> lengths(size), displs(size);
+    MPI_Gather(&length, 1, MPI_INT, &lengths[0], 1, MPI_INT, 0, comm);
+    std::vector<char> all;
+    if (rank == 0) {
+        int total = 0;
+        for (int r = 0; r < size; r++) {
+            displs[r] = total;
+            total += lengths[r];
+        }
+        all.resize(std::max(total, 1));
+    }
+    MPI_Gatherv(&local[0], length, MPI_CHAR, rank == 0 ? &all[0] : NULL, &lengths[0], &displs[0], MPI_CHAR, 0, comm);
+
+    bool ok = true;
+    if (rank == 0) {
+        std::ofstream file(filename);
+        ok = (bool)file;
+        if (ok) {
+            // Every line ends in ",\n"; the last one must not have the comma
+            std::string events(all.begin(), all.begin() + displs[size - 1] + lengths[size - 1]);
+            if (events.size() >= 2) events.erase(events.size() - 2, 1);
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" << events << "]}\n";
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,46 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <vector>
+#include <mpi.h>
+
+// One timed span on this rank, in local MPI_Wtime seconds. name must be a string literal.
+struct TraceEvent {
+    double begin;
+    double end;
+    const char* name;
+    int iteration;
+};
+
+// Preallocated ring of events: once full, new events overwrite the oldest ones,
+// so a long run keeps its last capacity events and recording never allocates
+struct TraceBuffer {
+    std::vector<TraceEvent> events;
+    size_t next;     // Slot the next event goes to
+    size_t recorded; // Events recorded in total, including overwritten ones
+};
+
+void openTrace(TraceBuffer& trace, size_t capacity);
+
+inline void traceEvent(TraceBuffer* trace, const char* name, double begin, double end, int iteration) {
+    if (!trace || trace->events.empty()) return;
+    TraceEvent& e = trace->events[trace->next];
+    e.begin = begin;
+    e.end = end;
+    e.name = name;
+    e.iteration = iteration;
+    trace->next = (trace->next + 1) % trace->events.size();
+    trace->recorded++;
+}
+
+// This rank's MPI_Wtime minus rank 0's, estimated from the ping-pong with the smallest round trip.
+// 0 everywhere when the implementation reports MPI_WTIME_IS_GLOBAL. Collective over comm.
+double traceClockOffset(MPI_Comm comm);
+
+// Merge the events of all ranks of comm into one Chrome Trace Event file (chrome://tracing,
+// Perfetto), one process row per rank, on rank 0's clock. Collective; returns false on rank 0
+// if the file could not be written.
+bool writeChromeTrace(const TraceBuffer& trace, const char* filename, MPI_Comm comm);
+
+#endif